@@ -0,0 +1,67 @@
+#include "languages.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace active_learning;
+
+/**
+ * Median wall time of an equivalence check, in microseconds
+ */
+static double time_equivalence(const V1CA &left, V1CA &right, V1CA::equivalence_engine engine, size_t repetitions,
+                               std::optional<std::string> &result) {
+    auto times = std::vector<double>();
+    for (auto i = 0u; i < repetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        result = left.is_equivalent_to(right, engine);
+        auto end = std::chrono::steady_clock::now();
+        times.emplace_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+/**
+ * Compare the equivalence engines on the bundled languages:
+ * - equivalent: the reference against a copy of itself (the whole configuration space has to be explored)
+ * - redundant: two larger V1CA of the same language whose states do not match one to one (2 and 3 copies
+ *   of every reference state), as learned hypotheses compared to a reference
+ * - complement: the reference against its complement (early counter-example)
+ */
+int main(int argc, char **argv) {
+    auto repetitions = (argc > 1) ? std::stoul(argv[1]) : 20ul;
+    const auto engines = std::vector<std::pair<std::string, V1CA::equivalence_engine>>{
+            {"product", V1CA::equivalence_engine::product},
+            {"union_find", V1CA::equivalence_engine::union_find}};
+
+    std::cout << std::left << std::setw(12) << "language" << std::setw(14) << "case" << std::setw(12) << "engine"
+              << std::setw(14) << "median_us" << "counter_example\n";
+
+    for (const auto &lang : bench::bundled_languages()) {
+        auto alphabet = visibly_alphabet_t(lang.symbols);
+        auto ref = bench::reference_v1ca(lang, alphabet);
+        auto copy = bench::reference_v1ca(lang, alphabet);
+        auto double_ref = bench::reference_v1ca(lang, alphabet, 2);
+        auto triple_ref = bench::reference_v1ca(lang, alphabet, 3);
+        auto complement = ref.complement();
+
+        const auto cases = std::vector<std::tuple<std::string, V1CA *, V1CA *>>{
+                {"equivalent", &ref, &copy},
+                {"redundant", &double_ref, &triple_ref},
+                {"complement", &ref, &complement}};
+        for (const auto &[case_name, left, right] : cases) {
+            for (const auto &[engine_name, engine] : engines) {
+                auto result = std::optional<std::string>();
+                auto median = time_equivalence(*left, *right, engine, repetitions, result);
+                std::cout << std::setw(12) << lang.name << std::setw(14) << case_name << std::setw(12)
+                          << engine_name << std::setw(14) << std::fixed << std::setprecision(1) << median
+                          << (result ? '"' + *result + '"' : "none") << '\n';
+            }
+        }
+    }
+
+    return 0;
+}
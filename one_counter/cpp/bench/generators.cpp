@@ -0,0 +1,186 @@
+#include "generators.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+namespace active_learning::bench {
+
+    /**
+     * Random word of a visibly alphabet whose counter value goes from from_cv to to_cv without going below 0.
+     * The word is one symbol longer than asked when the length cannot be reached without a neutral symbol.
+     */
+    std::string random_word(std::mt19937 &rng, const std::map<char, int> &symbols, size_t length, int from_cv,
+                            int to_cv) {
+        auto by_effect = std::map<int, std::vector<char>>();
+        for (const auto &[symbol, effect] : symbols)
+            by_effect[effect].push_back(symbol);
+
+        auto distance = std::abs(to_cv - from_cv);
+        length = std::max<size_t>(length, distance);
+        if (!by_effect.contains(0) and (length - distance) % 2 == 1)
+            ++length;
+
+        auto res = std::string();
+        auto cv = from_cv;
+        for (auto left = static_cast<int>(length); left > 0; --left) {
+            // Effects which still let to_cv be reached with the symbols left
+            auto effects = std::vector<int>();
+            for (const auto &[effect, effect_symbols] : by_effect) {
+                auto next = cv + effect;
+                if (next >= 0 and std::abs(to_cv - next) <= left - 1 and
+                    (by_effect.contains(0) or (left - 1 - std::abs(to_cv - next)) % 2 == 0))
+                    effects.push_back(effect);
+            }
+
+            auto effect = effects[rng() % effects.size()];
+            const auto &effect_symbols = by_effect[effect];
+            res.push_back(effect_symbols[rng() % effect_symbols.size()]);
+            cv += effect;
+        }
+
+        return res;
+    }
+
+    std::string random_basic_word(std::mt19937 &rng, const std::set<char> &symbols, size_t length) {
+        const auto pool = std::vector<char>(symbols.begin(), symbols.end());
+        auto res = std::string();
+        for (auto i = 0ul; i < length; ++i)
+            res.push_back(pool[rng() % pool.size()]);
+
+        return res;
+    }
+
+    /**
+     * V1CA with a random transition on every (state, symbol) at every counter value, and about a third of its
+     * states final. State i is given the level i % (max_level + 1).
+     */
+    V1CA random_v1ca(std::mt19937 &rng, visibly_alphabet_t &alphabet, size_t states_n, size_t max_level) {
+        auto up = char(0);
+        auto neutral = char(0);
+        for (auto symbol : alphabet.symbols()) {
+            if (alphabet.get_cv(symbol) == 1 and !up)
+                up = symbol;
+            if (alphabet.get_cv(symbol) == 0 and !neutral)
+                neutral = symbol;
+        }
+
+        // Names are words reaching the level of their state, made distinct by neutral symbols
+        auto props = std::vector<V1CA::state_prop>();
+        for (auto state = 0ul; state < states_n; ++state) {
+            auto level = state % (max_level + 1);
+            props.push_back({level, std::string(level, up) + std::string(state / (max_level + 1), neutral)});
+        }
+
+        auto finals = std::vector<V1CA::state_t>();
+        for (auto state = 0ul; state < states_n; ++state) {
+            if (state == 0 or rng() % 3 == 0)
+                finals.emplace_back(state);
+        }
+
+        auto edges = std::vector<std::tuple<size_t, size_t, char>>();
+        for (auto state = 0ul; state < states_n; ++state) {
+            for (auto symbol : alphabet.symbols())
+                edges.emplace_back(state, rng() % states_n, symbol);
+        }
+
+        return V1CA(props, 0, finals, alphabet, edges);
+    }
+
+    /**
+     * R1CA with a random target and counter effect on every (state, symbol, counter value) up to max_level,
+     * the last guard covering every higher counter value
+     */
+    R1CA random_r1ca(std::mt19937 &rng, basic_alphabet_t &alphabet, size_t states_n, size_t max_level) {
+        auto transitions = R1CA::transition_func_t();
+        for (auto state = 0ul; state < states_n; ++state) {
+            for (auto symbol : alphabet.symbols()) {
+                for (auto cv = 0ul; cv <= max_level; ++cv) {
+                    // The counter cannot be decremented at 0
+                    auto effect = static_cast<int>(rng() % 3) - 1;
+                    if (cv == 0)
+                        effect = std::max(effect, 0);
+                    auto hi = (cv == max_level) ? R1CA::transition_func_t::unbounded : cv;
+                    transitions.assign(state, symbol, cv, hi, {rng() % states_n, effect});
+                }
+            }
+        }
+
+        auto finals = std::set<size_t>();
+        for (auto state = 0ul; state < states_n; ++state) {
+            if (state == 0 or rng() % 3 == 0)
+                finals.insert(state);
+        }
+
+        return R1CA::from_scratch(0, states_n, max_level, finals, transitions, alphabet);
+    }
+
+    /**
+     * Behaviour graph of a random V1CA unrolled over levels 0 to levels - 1, with states_n vertices per level.
+     * Graphs built from the same seed are isomorphic, the vertices of a shuffled one being added in another order.
+     */
+    behaviour_graph unrolled_behaviour_graph(std::mt19937 &rng, const std::map<char, int> &symbols,
+                                             size_t states_n, size_t levels, bool shuffled) {
+        const auto vertex_name = [](size_t state, size_t level) {
+            return "q" + std::to_string(state) + "_" + std::to_string(level);
+        };
+
+        auto targets = std::vector<size_t>();
+        for (auto i = 0ul; i < states_n * symbols.size(); ++i)
+            targets.push_back(rng() % states_n);
+        auto finals = std::set<std::string>();
+        for (auto state = 0ul; state < states_n; ++state) {
+            if (state == 0 or rng() % 3 == 0)
+                finals.insert(vertex_name(state, 0));
+        }
+
+        auto order = std::vector<size_t>(states_n * levels);
+        std::iota(order.begin(), order.end(), 0);
+        if (shuffled)
+            std::shuffle(order.begin(), order.end(), std::mt19937(static_cast<unsigned>(order.size())));
+
+        auto vertices = std::vector<std::pair<std::string, int>>();
+        auto edges = std::vector<std::tuple<std::string, char, int, std::string>>();
+        for (auto v : order) {
+            auto state = v % states_n;
+            auto level = v / states_n;
+            vertices.emplace_back(vertex_name(state, level), static_cast<int>(level));
+
+            auto symbol_i = 0ul;
+            for (const auto &[symbol, effect] : symbols) {
+                auto target_level = static_cast<long>(level) + effect;
+                if (target_level >= 0 and target_level < static_cast<long>(levels)) {
+                    edges.emplace_back(vertex_name(state, level), symbol, effect,
+                                       vertex_name(targets[state * symbols.size() + symbol_i],
+                                                   static_cast<size_t>(target_level)));
+                }
+                ++symbol_i;
+            }
+        }
+
+        return {vertices, edges, vertex_name(0, 0), finals};
+    }
+
+    /**
+     * RST with tables for counter values 0 to levels - 1, each one with about rows_n rows and cols_n columns of
+     * random words, filled by the teacher
+     */
+    RST synthetic_rst(std::mt19937 &rng, const std::map<char, int> &symbols, teacher &teacher, size_t levels,
+                      size_t rows_n, size_t cols_n, size_t word_length) {
+        auto rst = RST(teacher);
+        for (auto cv = 0; cv < static_cast<int>(levels); ++cv) {
+            // The "if not present" helpers expect the table to exist, which adding a row ensures
+            auto first_row = random_word(rng, symbols, word_length, 0, cv);
+            if (cv >= static_cast<int>(rst.size()))
+                rst.add_row_using_query(first_row, cv, teacher);
+            for (auto i = 1ul; i < rows_n; ++i)
+                rst.add_row_using_query_if_not_present(random_word(rng, symbols, word_length, 0, cv), cv, teacher,
+                                                       "synthetic_rst");
+            for (auto i = 0ul; i < cols_n; ++i)
+                rst.add_col_using_query_if_not_present(random_word(rng, symbols, word_length, cv, 0), cv, teacher,
+                                                       "synthetic_rst");
+        }
+
+        return rst;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "V1CA.h"
+#include "R1CA.h"
+#include "behaviour_graph.h"
+#include "dataframe.h"
+
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace active_learning::bench {
+
+    // Symbols of the synthetic visibly alphabet, one per counter effect
+    inline const std::map<char, int> synthetic_symbols = {{'a', 1}, {'b', -1}, {'c', 0}};
+
+    std::string random_word(std::mt19937 &rng, const std::map<char, int> &symbols, size_t length, int from_cv = 0,
+                            int to_cv = 0);
+
+    std::string random_basic_word(std::mt19937 &rng, const std::set<char> &symbols, size_t length);
+
+    V1CA random_v1ca(std::mt19937 &rng, visibly_alphabet_t &alphabet, size_t states_n, size_t max_level);
+
+    R1CA random_r1ca(std::mt19937 &rng, basic_alphabet_t &alphabet, size_t states_n, size_t max_level);
+
+    behaviour_graph unrolled_behaviour_graph(std::mt19937 &rng, const std::map<char, int> &symbols, size_t states_n,
+                                             size_t levels, bool shuffled = false);
+
+    RST synthetic_rst(std::mt19937 &rng, const std::map<char, int> &symbols, teacher &teacher, size_t levels,
+                      size_t rows_n, size_t cols_n, size_t word_length);
+}
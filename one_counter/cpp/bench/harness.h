@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace active_learning::bench {
+
+    // Keep a value alive, so the computation of a kernel is not optimized out
+    template<typename T>
+    inline void do_not_optimize(const T &value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    struct harness_options {
+        // Samples run and dropped before measuring, once the batch size is known
+        size_t warmup = 5;
+        size_t samples = 50;
+        // Fast kernels are called in batches, until a sample lasts at least this long
+        uint64_t min_sample_ns = 200000;
+        // Only kernels whose name contains it are run
+        std::string filter;
+    };
+
+    // Time of one call of a kernel on an input, over the samples
+    struct kernel_result {
+        std::string kernel;
+        std::string input;
+        size_t batch;
+        size_t samples;
+        double min_ns;
+        double p50_ns;
+        double p90_ns;
+        double p99_ns;
+        double max_ns;
+    };
+
+    /**
+     * Microbenchmark runner: a kernel is warmed up, then timed over a number of samples whose percentiles are
+     * reported. Results are printed to the report stream as they come, and can be written as CSV.
+     */
+    class harness {
+
+    public:
+        explicit harness(harness_options options = {}, std::ostream &report = std::cout)
+                : options_(std::move(options)), report_(report) {
+            options_.samples = std::max<size_t>(options_.samples, 1);
+            report_ << std::left << std::setw(34) << "kernel" << std::setw(32) << "input" << std::setw(9)
+                    << "batch" << std::setw(12) << "min_ns" << std::setw(12) << "p50_ns" << std::setw(12)
+                    << "p90_ns" << std::setw(12) << "p99_ns" << "max_ns\n";
+        }
+
+        [[nodiscard]] bool is_selected(const std::string &kernel) const {
+            return kernel.find(options_.filter) != std::string::npos;
+        }
+
+        /**
+         * Time a kernel called without arguments, in batches sized so that a sample is long enough to be measured
+         */
+        template<typename Kernel>
+        void run(const std::string &kernel, const std::string &input, Kernel &&call) {
+            if (!is_selected(kernel))
+                return;
+
+            auto batch = 1ul;
+            while (time_batch(call, batch) < options_.min_sample_ns and batch < (1ul << 24))
+                batch *= 2;
+            for (auto i = 0u; i < options_.warmup; ++i)
+                time_batch(call, batch);
+
+            auto times = std::vector<double>();
+            for (auto i = 0u; i < options_.samples; ++i)
+                times.push_back(static_cast<double>(time_batch(call, batch)) / static_cast<double>(batch));
+            add_result(kernel, input, batch, times);
+        }
+
+        /**
+         * Time a kernel called once per sample on a fresh state, the setup making the state not being timed
+         */
+        template<typename Setup, typename Kernel>
+        void run_with_setup(const std::string &kernel, const std::string &input, Setup &&setup, Kernel &&call) {
+            if (!is_selected(kernel))
+                return;
+
+            for (auto i = 0u; i < options_.warmup; ++i) {
+                auto state = setup();
+                call(state);
+            }
+
+            auto times = std::vector<double>();
+            for (auto i = 0u; i < options_.samples; ++i) {
+                auto state = setup();
+                auto start = std::chrono::steady_clock::now();
+                call(state);
+                auto end = std::chrono::steady_clock::now();
+                times.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+            }
+            add_result(kernel, input, 1, times);
+        }
+
+        [[nodiscard]] const std::vector<kernel_result> &get_results() const {
+            return results_;
+        }
+
+        void write_csv(const std::string &path) const {
+            auto out = std::ofstream(path);
+            if (!out.is_open())
+                throw std::runtime_error("write_csv(): Could not open '" + path + "'.");
+
+            out << "kernel,input,batch,samples,min_ns,p50_ns,p90_ns,p99_ns,max_ns\n" << std::fixed << std::setprecision(1);
+            for (const auto &result : results_) {
+                out << result.kernel << ',' << result.input << ',' << result.batch << ',' << result.samples << ','
+                    << result.min_ns << ',' << result.p50_ns << ',' << result.p90_ns << ',' << result.p99_ns << ','
+                    << result.max_ns << '\n';
+            }
+        }
+
+    private:
+        template<typename Kernel>
+        static uint64_t time_batch(Kernel &call, size_t batch) {
+            auto start = std::chrono::steady_clock::now();
+            for (auto i = 0ul; i < batch; ++i)
+                call();
+            auto end = std::chrono::steady_clock::now();
+
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+
+        // Nearest-rank percentile of sorted times
+        static double percentile(const std::vector<double> &sorted, double p) {
+            auto rank = static_cast<size_t>(p * static_cast<double>(sorted.size()) + 0.999999);
+            return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+        }
+
+        void add_result(const std::string &kernel, const std::string &input, size_t batch,
+                        std::vector<double> &times) {
+            std::sort(times.begin(), times.end());
+            auto result = kernel_result{kernel, input, batch, times.size(), times.front(), percentile(times, 0.5),
+                                        percentile(times, 0.9), percentile(times, 0.99), times.back()};
+
+            report_ << std::setw(34) << result.kernel << std::setw(32) << result.input << std::setw(9)
+                    << result.batch << std::fixed << std::setprecision(1) << std::setw(12) << result.min_ns
+                    << std::setw(12) << result.p50_ns << std::setw(12) << result.p90_ns << std::setw(12)
+                    << result.p99_ns << result.max_ns << std::endl;
+            results_.push_back(std::move(result));
+        }
+
+        harness_options options_;
+        std::ostream &report_;
+        std::vector<kernel_result> results_;
+    };
+}
@@ -0,0 +1,168 @@
+#include "languages.h"
+
+namespace active_learning::bench {
+
+    /**
+     * Build the reference V1CA of a language (the alphabet must outlive it).
+     * With more than one copy, every state is duplicated and transitions go from copy j to copy (j + 1) % copies,
+     * giving a larger V1CA with the same language.
+     */
+    V1CA reference_v1ca(const language &lang, visibly_alphabet_t &alphabet, size_t copies) {
+        auto props = std::vector<V1CA::state_prop>();
+        for (const auto &name : lang.state_names) {
+            for (auto j = 0u; j < copies; ++j)
+                props.push_back({static_cast<size_t>(alphabet.get_cv(name)), name});
+        }
+
+        auto finals = std::vector<V1CA::state_t>();
+        for (auto final : lang.finals) {
+            for (auto j = 0u; j < copies; ++j)
+                finals.emplace_back(final * copies + j);
+        }
+
+        auto edges = std::vector<std::tuple<size_t, size_t, char>>();
+        for (const auto &[src, dst, symbol] : lang.edges) {
+            for (auto j = 0u; j < copies; ++j)
+                edges.emplace_back(src * copies + j, dst * copies + (j + 1) % copies, symbol);
+        }
+
+        return V1CA(props, 0, finals, alphabet, edges);
+    }
+
+    /**
+     * Match word against x* U^n y* D^n z*, where symbols of up (resp. down) increase (resp. decrease)
+     * the counter, and x, y, z are optional padding symbols (0 to disable them).
+     */
+    static bool is_padded_up_down(const std::string &word, const std::string &up, const std::string &down,
+                                  char x, char y, char z) {
+        auto i = 0u;
+        auto skip = [&](char c) {
+            while (c and i < word.size() and word[i] == c)
+                ++i;
+        };
+        auto count = [&](const std::string &symbols) {
+            auto n = 0u;
+            while (i < word.size() and symbols.find(word[i]) != std::string::npos) {
+                ++i;
+                ++n;
+            }
+            return n;
+        };
+
+        skip(x);
+        auto n_up = count(up);
+        skip(y);
+        auto n_down = count(down);
+        skip(z);
+
+        return n_up == n_down and i == word.size();
+    }
+
+    std::vector<language> bundled_languages() {
+        auto res = std::vector<language>();
+
+        res.push_back({"anbn", {{'a', 1}, {'b', -1}},
+                       [](const std::string &w) { return is_padded_up_down(w, "a", "b", 0, 0, 0); },
+                       {"", "a", "ab"}, {0, 2},
+                       {{0, 1, 'a'}, {1, 1, 'a'}, {1, 2, 'b'}, {2, 2, 'b'}}});
+
+        res.push_back({"ancbn", {{'a', 1}, {'b', -1}, {'c', 0}},
+                       [](const std::string &w) { return is_padded_up_down(w, "a", "b", 0, 'c', 0); },
+                       {"", "a", "c", "ab"}, {0, 2, 3},
+                       {{0, 1, 'a'}, {0, 2, 'c'}, {1, 1, 'a'}, {1, 2, 'c'}, {1, 3, 'b'},
+                        {2, 2, 'c'}, {2, 3, 'b'}, {3, 3, 'b'}}});
+
+        res.push_back({"xanybnz", {{'a', 1}, {'b', -1}, {'x', 0}, {'y', 0}, {'z', 0}},
+                       [](const std::string &w) { return is_padded_up_down(w, "a", "b", 'x', 'y', 'z'); },
+                       {"", "a", "ay", "ab", "abz"}, {0, 2, 3, 4},
+                       {{0, 0, 'x'}, {0, 1, 'a'}, {0, 2, 'y'}, {0, 4, 'z'},
+                        {1, 1, 'a'}, {1, 2, 'y'}, {1, 3, 'b'},
+                        {2, 2, 'y'}, {2, 3, 'b'}, {2, 4, 'z'},
+                        {3, 3, 'b'}, {3, 4, 'z'}, {4, 4, 'z'}}});
+
+        res.push_back({"xabnycdnz", {{'a', 1}, {'b', 1}, {'c', -1}, {'d', -1}, {'x', 0}, {'y', 0}, {'z', 0}},
+                       [](const std::string &w) { return is_padded_up_down(w, "ab", "cd", 'x', 'y', 'z'); },
+                       {"", "a", "ay", "ac", "acz"}, {0, 2, 3, 4},
+                       {{0, 0, 'x'}, {0, 1, 'a'}, {0, 1, 'b'}, {0, 2, 'y'}, {0, 4, 'z'},
+                        {1, 1, 'a'}, {1, 1, 'b'}, {1, 2, 'y'}, {1, 3, 'c'}, {1, 3, 'd'},
+                        {2, 2, 'y'}, {2, 3, 'c'}, {2, 3, 'd'}, {2, 4, 'z'},
+                        {3, 3, 'c'}, {3, 3, 'd'}, {3, 4, 'z'}, {4, 4, 'z'}}});
+
+        return res;
+    }
+
+    /**
+     * Match word against a^n c^m b^n, with m a multiple of modulo
+     */
+    static bool is_up_modulo_down(const std::string &word, size_t modulo) {
+        auto i = 0u;
+        auto count = [&](char c) {
+            auto n = 0u;
+            for (; i < word.size() and word[i] == c; ++i)
+                ++n;
+            return n;
+        };
+
+        auto n_up = count('a');
+        auto n_middle = count('c');
+        auto n_down = count('b');
+
+        return n_up == n_down and n_middle % modulo == 0 and i == word.size();
+    }
+
+    /**
+     * Families of languages growing with their size parameter k, from 1 to max_size:
+     * - updown<k>: U^n D^n, with k symbols increasing the counter and k symbols decreasing it
+     * - cmod<k>: a^n c^m b^n, with m a multiple of k, whose reference has k states counting the c
+     */
+    std::vector<language> parametric_languages(size_t max_size) {
+        auto res = std::vector<language>();
+
+        for (auto k = 1ul; k <= max_size; ++k) {
+            auto lang = language();
+            lang.name = "updown" + std::to_string(k);
+            auto up = std::string();
+            auto down = std::string();
+            for (auto i = 0ul; i < k; ++i) {
+                up.push_back(static_cast<char>('a' + i));
+                down.push_back(static_cast<char>('a' + k + i));
+                lang.symbols[up.back()] = 1;
+                lang.symbols[down.back()] = -1;
+            }
+
+            lang.contains = [up, down](const std::string &w) { return is_padded_up_down(w, up, down, 0, 0, 0); };
+            lang.state_names = {"", up.substr(0, 1), up.substr(0, 1) + down.substr(0, 1)};
+            lang.finals = {0, 2};
+            for (auto i = 0ul; i < k; ++i) {
+                lang.edges.emplace_back(0, 1, up[i]);
+                lang.edges.emplace_back(1, 1, up[i]);
+                lang.edges.emplace_back(1, 2, down[i]);
+                lang.edges.emplace_back(2, 2, down[i]);
+            }
+            res.push_back(std::move(lang));
+        }
+
+        for (auto k = 1ul; k <= max_size; ++k) {
+            // States: "", "a", then c^j for the number j of c read modulo k (c^k standing for 0), then "ab"
+            auto lang = language();
+            lang.name = "cmod" + std::to_string(k);
+            lang.symbols = {{'a', 1}, {'b', -1}, {'c', 0}};
+            lang.contains = [k](const std::string &w) { return is_up_modulo_down(w, k); };
+            lang.state_names = {"", "a"};
+            for (auto j = 1ul; j <= k; ++j)
+                lang.state_names.push_back(std::string(j, 'c'));
+            lang.state_names.emplace_back("ab");
+
+            auto last_c = k + 1;
+            auto down = k + 2;
+            lang.finals = {0, last_c, down};
+            lang.edges = {{0, 1, 'a'}, {1, 1, 'a'}, {0, 2, 'c'}, {1, 2, 'c'}, {1, down, 'b'},
+                          {last_c, down, 'b'}, {down, down, 'b'}};
+            for (auto j = 2ul; j <= last_c; ++j)
+                lang.edges.emplace_back(j, (j == last_c) ? 2 : j + 1, 'c');
+            res.push_back(std::move(lang));
+        }
+
+        return res;
+    }
+}
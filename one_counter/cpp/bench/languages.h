@@ -0,0 +1,29 @@
+#pragma once
+
+#include "V1CA.h"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace active_learning::bench {
+
+    // A target language used by the benchmarks, with a membership predicate and a reference V1CA whose
+    // transitions do not depend on the counter value
+    struct language {
+        std::string name;
+        std::map<char, int> symbols;
+        std::function<bool(const std::string &)> contains;
+        // State names must be words of the alphabet, the max level is the highest cv of a name
+        std::vector<std::string> state_names;
+        std::vector<V1CA::state_t> finals;
+        std::vector<std::tuple<size_t, size_t, char>> edges;
+    };
+
+    std::vector<language> bundled_languages();
+
+    std::vector<language> parametric_languages(size_t max_size);
+
+    V1CA reference_v1ca(const language &lang, visibly_alphabet_t &alphabet, size_t copies = 1);
+}
@@ -0,0 +1,254 @@
+#include "languages.h"
+#include "learner.h"
+#include "trace.h"
+#include "allocation_tracker.h"
+#include "teachers/automatic_v1ca_teacher.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <set>
+#include <sstream>
+
+using namespace active_learning;
+
+/**
+ * Teacher counting the queries the learner asks, before they reach the cache of the teacher it forwards them to
+ */
+class counting_teacher : public teacher {
+
+public:
+    explicit counting_teacher(teacher &inner) : inner_(inner) {}
+
+    bool membership_query(const std::string &word) override {
+        ++membership_n;
+        return inner_.membership_query(word);
+    }
+
+    std::vector<bool> membership_queries(const std::vector<std::string> &words) override {
+        membership_n += words.size();
+        return inner_.membership_queries(words);
+    }
+
+    std::optional<std::string>
+    partial_equivalence_query(behaviour_graph &behaviour_graph, const std::string &path) override {
+        ++partial_equivalence_n;
+        return inner_.partial_equivalence_query(behaviour_graph, path);
+    }
+
+    std::optional<std::string> equivalence_query(one_counter_automaton &automaton, const std::string &path) override {
+        ++equivalence_n;
+        return inner_.equivalence_query(automaton, path);
+    }
+
+    [[nodiscard]] size_t get_membership_queries_n() const override {
+        return inner_.get_membership_queries_n();
+    }
+
+    size_t membership_n = 0;
+    size_t partial_equivalence_n = 0;
+    size_t equivalence_n = 0;
+
+private:
+    teacher &inner_;
+};
+
+struct run_result {
+    std::string language;
+    // "ok", "wrong" if the learned V1CA is not equivalent to the reference, or the message of an exception
+    std::string outcome;
+    double total_ms = 0;
+    learning_stats stats;
+    size_t membership_n = 0;
+    size_t distinct_membership_n = 0;
+    size_t partial_equivalence_n = 0;
+    size_t equivalence_n = 0;
+    size_t peak_live_bytes = 0;
+    // Inclusive wall time of every span name, nested spans being counted in their parents too
+    std::map<std::string, double> phases_ms;
+};
+
+/**
+ * Learn a language from its reference V1CA, the output of the learner being discarded
+ */
+static run_result run(const bench::language &lang) {
+    auto res = run_result();
+    res.language = lang.name;
+
+    // The learner and the automata print their steps
+    auto silenced = std::stringstream();
+    auto *cout_buffer = std::cout.rdbuf(silenced.rdbuf());
+
+    auto alphabet = visibly_alphabet_t(lang.symbols);
+    auto ref = bench::reference_v1ca(lang, alphabet);
+    auto inner = automatic_v1ca_teacher(ref, alphabet);
+    auto teacher = counting_teacher(inner);
+    auto learn = learner(teacher, alphabet);
+
+    auto &tracker = allocation_tracker::get_default();
+    auto &trace = tracer::get_default();
+    tracker.reset_peak();
+    auto peak_origin = tracker.get_live_bytes();
+    trace.start(trace_output::chrome_json, "");
+
+    auto start = std::chrono::steady_clock::now();
+    auto learned = std::optional<V1CA>();
+    try {
+        learned.emplace(learn.learn_V1CA(false));
+    } catch (const std::exception &e) {
+        res.outcome = e.what();
+    }
+    res.total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    trace.stop();
+    res.peak_live_bytes = tracker.get_peak_live_bytes() - peak_origin;
+
+    // Checked once the measures are taken
+    if (learned)
+        res.outcome = learned->is_equivalent_to(ref) ? "wrong" : "ok";
+    std::cout.rdbuf(cout_buffer);
+
+    for (const auto &event : trace.get_events())
+        res.phases_ms[event.name] += static_cast<double>(event.duration_ns) / 1e6;
+    res.stats = learn.get_stats();
+    res.membership_n = teacher.membership_n;
+    res.distinct_membership_n = teacher.get_membership_queries_n();
+    res.partial_equivalence_n = teacher.partial_equivalence_n;
+    res.equivalence_n = teacher.equivalence_n;
+
+    return res;
+}
+
+static std::string csv_field(const std::string &text) {
+    auto res = std::string("\"");
+    for (auto c : text) {
+        if (c == '"')
+            res.push_back('"');
+        res.push_back(c);
+    }
+
+    return res + '"';
+}
+
+static std::string quoted(const std::string &text) {
+    auto res = std::string("\"");
+    for (auto c : text) {
+        if (c == '"' or c == '\\')
+            res.push_back('\\');
+        res.push_back(c);
+    }
+
+    return res + '"';
+}
+
+/**
+ * One line per language, with a column per phase seen in any run (empty when tracing is not compiled in)
+ */
+static void write_csv(const std::string &path, const std::vector<run_result> &results) {
+    auto phases = std::set<std::string>();
+    for (const auto &result : results) {
+        for (const auto &[phase, ms] : result.phases_ms)
+            phases.insert(phase);
+    }
+
+    auto out = std::ofstream(path);
+    if (!out.is_open())
+        throw std::runtime_error("write_csv(): Could not open '" + path + "'.");
+
+    out << "language,outcome,total_ms,rounds,membership_queries,distinct_membership_queries,"
+           "partial_equivalence_queries,equivalence_queries,rst_tables,rst_rows,rst_cols,peak_live_bytes";
+    for (const auto &phase : phases)
+        out << ",ms:" << phase;
+    out << '\n';
+
+    for (const auto &result : results) {
+        out << result.language << ',' << csv_field(result.outcome) << ',' << result.total_ms << ','
+            << result.stats.rounds << ',' << result.membership_n << ',' << result.distinct_membership_n << ','
+            << result.partial_equivalence_n << ',' << result.equivalence_n << ',' << result.stats.rst_tables << ','
+            << result.stats.rst_rows << ',' << result.stats.rst_cols << ',';
+        if (allocation_tracker::is_enabled())
+            out << result.peak_live_bytes;
+        for (const auto &phase : phases) {
+            out << ',';
+            if (result.phases_ms.contains(phase))
+                out << result.phases_ms.at(phase);
+        }
+        out << '\n';
+    }
+}
+
+static void write_json(const std::string &path, const std::vector<run_result> &results) {
+    auto out = std::ofstream(path);
+    if (!out.is_open())
+        throw std::runtime_error("write_json(): Could not open '" + path + "'.");
+
+#ifdef V1C2AL_TRACE
+    out << "{\n  \"trace\": true,\n";
+#else
+    out << "{\n  \"trace\": false,\n";
+#endif
+    out << "  \"allocation_tracking\": " << (allocation_tracker::is_enabled() ? "true" : "false")
+        << ",\n  \"runs\": [";
+    for (auto i = 0ul; i < results.size(); ++i) {
+        const auto &result = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"language\":" << quoted(result.language)
+            << ",\"outcome\":" << quoted(result.outcome)
+            << ",\"total_ms\":" << result.total_ms
+            << ",\"rounds\":" << result.stats.rounds
+            << ",\"membership_queries\":" << result.membership_n
+            << ",\"distinct_membership_queries\":" << result.distinct_membership_n
+            << ",\"partial_equivalence_queries\":" << result.partial_equivalence_n
+            << ",\"equivalence_queries\":" << result.equivalence_n
+            << ",\"rst_tables\":" << result.stats.rst_tables
+            << ",\"rst_rows\":" << result.stats.rst_rows
+            << ",\"rst_cols\":" << result.stats.rst_cols
+            << ",\"peak_live_bytes\":";
+        if (allocation_tracker::is_enabled())
+            out << result.peak_live_bytes;
+        else
+            out << "null";
+        out << ",\"phases_ms\":{";
+        auto first = true;
+        for (const auto &[phase, ms] : result.phases_ms) {
+            out << (first ? "" : ",") << quoted(phase) << ':' << ms;
+            first = false;
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+/**
+ * Learn every bundled language (which include the ones of python/results) and the parametric families up to a
+ * size, writing the results to <prefix>.csv and <prefix>.json.
+ * Per phase times need a build with V1C2AL_TRACE, and peak memory one with V1C2AL_ALLOC_TRACKING.
+ * Usage: v1c2al_bench [max_size = 4] [prefix = v1c2al_bench]
+ */
+int main(int argc, char **argv) {
+    auto max_size = (argc > 1) ? std::stoul(argv[1]) : 4ul;
+    auto prefix = (argc > 2) ? std::string(argv[2]) : std::string("v1c2al_bench");
+
+    auto languages = bench::bundled_languages();
+    for (auto &lang : bench::parametric_languages(max_size))
+        languages.push_back(std::move(lang));
+
+    std::cout << std::left << std::setw(12) << "language" << std::setw(8) << "outcome" << std::setw(12)
+              << "total_ms" << std::setw(8) << "rounds" << std::setw(12) << "membership" << std::setw(13)
+              << "equivalence" << "rst_rows\n";
+
+    auto results = std::vector<run_result>();
+    for (const auto &lang : languages) {
+        results.push_back(run(lang));
+        const auto &result = results.back();
+        std::cout << std::setw(12) << result.language << std::setw(8) << result.outcome << std::setw(12)
+                  << std::fixed << std::setprecision(1) << result.total_ms << std::setw(8) << result.stats.rounds
+                  << std::setw(12) << result.distinct_membership_n << std::setw(13) << result.equivalence_n
+                  << result.stats.rst_rows << std::endl;
+    }
+
+    write_csv(prefix + ".csv", results);
+    write_json(prefix + ".json", results);
+
+    return 0;
+}
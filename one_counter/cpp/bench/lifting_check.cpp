@@ -0,0 +1,104 @@
+#include "V1CA_reader.h"
+
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using namespace active_learning;
+
+/**
+ * Text of a random V1CA whose transitions depend on the counter value up to its max level, the last value
+ * standing for every higher one. Decrementing symbols have no transition at 0.
+ */
+static std::string random_v1ca_text(std::mt19937 &rng, const std::map<char, int> &symbols, size_t states_n,
+                                    size_t max_level) {
+    auto out = std::stringstream();
+    out << states_n << '\n' << max_level << '\n';
+    for (auto state = 0u; state < states_n; ++state)
+        out << "state " << state << ' ' << ((state == 0) ? 0 : rng() % (max_level + 1)) << " q" << state << '\n';
+    out << "init 0\nfinal 0";
+    for (auto state = 1u; state < states_n; ++state) {
+        if (rng() % 2)
+            out << ' ' << state;
+    }
+    out << '\n';
+
+    for (auto state = 0u; state < states_n; ++state) {
+        for (const auto &[symbol, effect] : symbols) {
+            for (auto cv = (effect < 0) ? 1ul : 0ul; cv <= max_level; ++cv) {
+                if (rng() % 5 == 0)
+                    continue;
+                out << state << "->" << rng() % states_n << ' ' << symbol << ' ' << cv
+                    << ((cv == max_level) ? "+" : "") << '\n';
+            }
+        }
+    }
+
+    return out.str();
+}
+
+// Every word up to a length, and words climbing high above the max levels
+static std::vector<std::string> enumerate_words(const std::string &symbols, size_t max_length) {
+    auto res = std::vector<std::string>{""};
+    for (auto begin = 0ul; res[begin].size() < max_length; ++begin) {
+        for (auto symbol : symbols)
+            res.push_back(res[begin] + symbol);
+        if (begin + 1 == res.size())
+            break;
+    }
+    for (auto n = 1ul; n <= 12; ++n) {
+        for (const auto *middle : {"", "c", "ab", "ba", "cc"})
+            res.push_back(std::string(n, 'a') + middle + std::string(n, 'b'));
+    }
+
+    return res;
+}
+
+/**
+ * Compare the languages of random V1CA before and after raising their max level, and of their intersections,
+ * on enumerated words. Exits with 1 if a word is accepted differently.
+ * Usage: v1c2al_lifting_check [cases = 500]
+ */
+int main(int argc, char **argv) {
+    auto cases = (argc > 1) ? std::stoul(argv[1]) : 500ul;
+    const auto symbols = std::map<char, int>{{'a', 1}, {'b', -1}, {'c', 0}};
+    auto alphabet = visibly_alphabet_t(symbols);
+    const auto words = enumerate_words("abc", 7);
+
+    // Automata print their transitions when they are built
+    auto report = std::ostream(std::cout.rdbuf());
+    auto silenced = std::stringstream();
+    std::cout.rdbuf(silenced.rdbuf());
+
+    // a^n b^n, n > 0: climbing above the max level once lifted
+    const auto anbn = std::string("3\n1\nstate 0 0 q0\nstate 1 1 q1\nstate 2 1 q2\ninit 0\nfinal 0 2\n"
+                                  "0->1 a 0\n1->1 a 1+\n1->2 b 1+\n2->2 b 1+\n");
+
+    auto rng = std::mt19937(42);
+    auto mismatches = 0ul;
+    for (auto i = 0ul; i < cases; ++i) {
+        auto left = read_v1ca_from_buffer((i == 0) ? anbn : random_v1ca_text(rng, symbols, 2 + rng() % 3, rng() % 3),
+                                          alphabet);
+        auto right = read_v1ca_from_buffer(random_v1ca_text(rng, symbols, 2 + rng() % 3, rng() % 3), alphabet);
+        auto lifted = V1CA(left);
+        lifted.increase_max_level(1 + rng() % 3);
+        auto inter = left.inter_with(right);
+
+        for (const auto &word : words) {
+            auto accepted = left.accepts(word);
+            if (lifted.accepts(word) != accepted) {
+                report << "case " << i << ": lifting changes the acceptance of '" << word << "'\n";
+                ++mismatches;
+                break;
+            }
+            if (inter.accepts(word) != (accepted and right.accepts(word))) {
+                report << "case " << i << ": intersection changes the acceptance of '" << word << "'\n";
+                ++mismatches;
+                break;
+            }
+        }
+    }
+
+    report << mismatches << " mismatching cases out of " << cases << std::endl;
+    return mismatches ? 1 : 0;
+}
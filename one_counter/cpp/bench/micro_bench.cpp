@@ -0,0 +1,183 @@
+#include "harness.h"
+#include "generators.h"
+#include "language.h"
+#include "teachers/automatic_v1ca_teacher.h"
+
+#include <sstream>
+
+using namespace active_learning;
+using namespace active_learning::bench;
+
+namespace {
+    // Every input is generated from its own fixed seed, so runs of different versions time the same inputs
+    constexpr unsigned seed = 42;
+
+    constexpr size_t words_n = 256;
+
+    std::string input_name(std::initializer_list<std::pair<const char *, size_t>> sizes) {
+        auto res = std::string();
+        for (const auto &[key, value] : sizes)
+            res += (res.empty() ? "" : ";") + std::string(key) + '=' + std::to_string(value);
+
+        return res;
+    }
+
+    void bench_words(harness &bench) {
+        auto alphabet = visibly_alphabet_t(synthetic_symbols);
+        for (auto length : {16ul, 256ul, 4096ul}) {
+            auto rng = std::mt19937(seed);
+            auto words = std::vector<std::string>();
+            for (auto i = 0ul; i < words_n; ++i)
+                words.push_back(random_word(rng, synthetic_symbols, length, 0, static_cast<int>(rng() % 4)));
+
+            auto i = 0ul;
+            bench.run("visibly_alphabet::get_cv", input_name({{"length", length}}), [&] {
+                do_not_optimize(alphabet.get_cv(words[i++ % words_n]));
+            });
+        }
+    }
+
+    void bench_v1ca(harness &bench) {
+        auto alphabet = visibly_alphabet_t(synthetic_symbols);
+        for (auto states_n : {8ul, 64ul}) {
+            for (auto length : {16ul, 256ul}) {
+                auto rng = std::mt19937(seed);
+                auto automaton = random_v1ca(rng, alphabet, states_n, 3);
+                auto words = std::vector<std::string>();
+                for (auto i = 0ul; i < words_n; ++i)
+                    words.push_back(random_word(rng, synthetic_symbols, length));
+
+                auto i = 0ul;
+                bench.run("V1CA::accepts", input_name({{"states", states_n}, {"length", length}}), [&] {
+                    do_not_optimize(automaton.accepts(words[i++ % words_n]));
+                });
+            }
+        }
+
+        // Equivalent automata have the whole configuration space explored
+        for (auto states_n : {4ul, 8ul}) {
+            auto rng = std::mt19937(seed);
+            auto left = random_v1ca(rng, alphabet, states_n, 2);
+            auto right = V1CA(left);
+            const auto engines = std::vector<std::pair<std::string, V1CA::equivalence_engine>>{
+                    {"product", V1CA::equivalence_engine::product},
+                    {"union_find", V1CA::equivalence_engine::union_find}};
+            for (const auto &[engine_name, engine] : engines) {
+                bench.run("V1CA::is_equivalent_to/" + engine_name, input_name({{"states", states_n}}), [&] {
+                    do_not_optimize(left.is_equivalent_to(right, engine));
+                });
+            }
+        }
+    }
+
+    void bench_r1ca(harness &bench) {
+        auto alphabet = basic_alphabet_t({'a', 'b', 'c'});
+        for (auto states_n : {8ul, 64ul}) {
+            for (auto length : {16ul, 256ul}) {
+                auto rng = std::mt19937(seed);
+                auto automaton = random_r1ca(rng, alphabet, states_n, 3);
+                auto words = std::vector<std::string>();
+                for (auto i = 0ul; i < words_n; ++i)
+                    words.push_back(random_basic_word(rng, alphabet.symbols(), length));
+
+                auto input = input_name({{"states", states_n}, {"length", length}});
+                auto i = 0ul;
+                bench.run("R1CA::evaluate", input, [&] {
+                    do_not_optimize(automaton.evaluate(words[i++ % words_n]));
+                });
+                bench.run("R1CA::count", input, [&] {
+                    do_not_optimize(automaton.count(words[i++ % words_n]));
+                });
+            }
+        }
+    }
+
+    void bench_rst(harness &bench) {
+        auto alphabet = visibly_alphabet_t(synthetic_symbols);
+        for (auto size : {16ul, 128ul}) {
+            auto rng = std::mt19937(seed);
+            auto reference = random_v1ca(rng, alphabet, 16, 3);
+            auto teacher = automatic_v1ca_teacher(reference, alphabet);
+            auto rst = synthetic_rst(rng, synthetic_symbols, teacher, 4, size, size, 12);
+            auto input = input_name({{"levels", 4}, {"rows", size}, {"cols", size}});
+
+            // Rows of the table of counter value 1, compared pairwise
+            const auto &rows = rst.get_ctables()[1].get_row_labels();
+            auto i = 0ul;
+            bench.run("RST::compare_rows", input, [&] {
+                const auto &row1 = rows[i % rows.size()];
+                const auto &row2 = rows[(i * 7 + 3) % rows.size()];
+                ++i;
+                do_not_optimize(rst.compare_rows(row1, row2, 1));
+            });
+
+            bench.run("RST::remove_duplicate_rows", input, [&] {
+                do_not_optimize(rst.remove_duplicate_rows());
+            });
+
+            // Columns are new words, so the teacher is asked for some of the cells
+            auto columns = std::vector<std::string>();
+            for (auto j = 0ul; j < words_n; ++j)
+                columns.push_back(random_word(rng, synthetic_symbols, 12, 1, 0));
+            auto column = 0ul;
+            bench.run_with_setup("RST_table::add_col_using_query", input,
+                                 [&] { return rst.get_ctables()[1]; },
+                                 [&](RST::RST_table &table) {
+                                     table.add_col_using_query(columns[column++ % words_n], teacher);
+                                 });
+
+            // Words which are not rows of the RST, so is_O_equivalent has to add them to its copy. They are drawn
+            // again for every sample: the teacher caches its answers, so reused words would skip the queries.
+            bench.run_with_setup("is_O_equivalent", input,
+                                 [&] {
+                                     return std::make_pair(random_word(rng, synthetic_symbols, 12, 0, 1),
+                                                           random_word(rng, synthetic_symbols, 12, 0, 1));
+                                 },
+                                 [&](std::pair<std::string, std::string> &words) {
+                                     do_not_optimize(is_O_equivalent(words.first, words.second, 1, rst, teacher));
+                                 });
+        }
+    }
+
+    void bench_behaviour_graph(harness &bench) {
+        auto alphabet = visibly_alphabet_t(synthetic_symbols);
+        for (auto states_n : {8ul, 32ul}) {
+            for (auto levels : {8ul, 32ul}) {
+                auto rng = std::mt19937(seed);
+                auto left = unrolled_behaviour_graph(rng, synthetic_symbols, states_n, levels);
+                rng = std::mt19937(seed);
+                auto right = unrolled_behaviour_graph(rng, synthetic_symbols, states_n, levels, true);
+
+                bench.run("behaviour_graph::is_isomorphic_to", input_name({{"states", states_n}, {"levels", levels}}),
+                          [&] { do_not_optimize(left.is_isomorphic_to(right, 0, 0, alphabet)); });
+            }
+        }
+    }
+}
+
+/**
+ * Time the hot kernels of the learner on synthetic inputs of growing size, and write the percentiles to a CSV.
+ * Usage: v1c2al_micro_bench [filter = ""] [samples = 50] [csv = v1c2al_micro_bench.csv]
+ */
+int main(int argc, char **argv) {
+    auto options = harness_options();
+    options.filter = (argc > 1) ? argv[1] : "";
+    options.samples = (argc > 2) ? std::stoul(argv[2]) : options.samples;
+    auto path = (argc > 3) ? std::string(argv[3]) : std::string("v1c2al_micro_bench.csv");
+
+    // Automata print their transitions when they are built, so only the report goes to the standard output
+    auto report = std::ostream(std::cout.rdbuf());
+    auto silenced = std::stringstream();
+    std::cout.rdbuf(silenced.rdbuf());
+
+    auto bench = harness(options, report);
+    bench_words(bench);
+    bench_v1ca(bench);
+    bench_r1ca(bench);
+    bench_rst(bench);
+    bench_behaviour_graph(bench);
+
+    bench.write_csv(path);
+
+    return 0;
+}
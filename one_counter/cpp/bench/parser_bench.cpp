@@ -0,0 +1,79 @@
+#include "V1CA_reader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace active_learning;
+
+/**
+ * Write a synthetic .v1ca file with a transition on every (state, counter value, symbol) up to the max level
+ * @param ranges true to write one "lo+" range per (state, symbol) instead of one line per counter value
+ * @return The number of transitions of the V1CA
+ */
+static size_t write_synthetic_v1ca(const std::string &path, size_t states_n, size_t max_level,
+                                   const std::string &symbols, bool ranges) {
+    auto rng = std::mt19937(42);
+    auto out = std::ofstream(path);
+    out << "# Synthetic V1CA\n" << states_n << '\n' << max_level << '\n';
+    for (auto state = 0u; state < states_n; ++state)
+        out << "state " << state << ' ' << state % (max_level + 1) << " q" << state << '\n';
+    out << "init 0\nfinal 0\n";
+
+    for (auto state = 0u; state < states_n; ++state) {
+        if (ranges) {
+            for (auto symbol : symbols)
+                out << state << "->" << rng() % states_n << ' ' << symbol << " 0+\n";
+        } else {
+            for (auto cv = 0u; cv <= max_level; ++cv) {
+                for (auto symbol : symbols)
+                    out << state << "->" << rng() % states_n << ' ' << symbol << ' ' << cv << '\n';
+            }
+        }
+    }
+
+    return states_n * (max_level + 1) * symbols.size();
+}
+
+/**
+ * Time the parsing of synthetic .v1ca files of about a million transitions (argv[1] to change it),
+ * written with one line per transition and with counter ranges
+ */
+int main(int argc, char **argv) {
+    auto transitions_n = (argc > 1) ? std::stoul(argv[1]) : 1000000ul;
+    auto repetitions = (argc > 2) ? std::stoul(argv[2]) : 5ul;
+
+    auto symbols_map = std::map<char, int>({{'a', 1}, {'b', -1}, {'c', 0}});
+    auto alphabet = visibly_alphabet_t(symbols_map);
+    const auto max_level = 99ul;
+    const auto states_n = std::max(1ul, transitions_n / (3 * (max_level + 1)));
+
+    std::cout << std::left << std::setw(10) << "layout" << std::setw(14) << "transitions" << std::setw(12)
+              << "size_MB" << std::setw(12) << "median_ms" << "transitions_per_s\n";
+
+    for (auto ranges : {false, true}) {
+        const auto path = std::string(ranges ? "parser_bench_ranges.v1ca" : "parser_bench_lines.v1ca");
+        auto expected = write_synthetic_v1ca(path, states_n, max_level, "abc", ranges);
+        auto size = std::ifstream(path, std::ios::ate | std::ios::binary).tellg();
+
+        auto times = std::vector<double>();
+        for (auto i = 0u; i < repetitions; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            auto automaton = read_v1ca_from_file(path, alphabet);
+            auto end = std::chrono::steady_clock::now();
+            times.emplace_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        std::remove(path.c_str());
+
+        std::sort(times.begin(), times.end());
+        auto median = times[times.size() / 2];
+        std::cout << std::setw(10) << (ranges ? "ranges" : "lines") << std::setw(14) << expected << std::setw(12)
+                  << std::fixed << std::setprecision(1) << static_cast<double>(size) / 1e6 << std::setw(12) << median
+                  << std::setprecision(0) << static_cast<double>(expected) / median * 1000 << '\n';
+    }
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "learner.h"
+#include "teachers/automaton_teacher.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace active_learning;
+
+namespace {
+    /**
+     * Automaton teacher answering equivalence queries on its own, with the shortest countable word up to a length
+     * on which the hypothesis and the reference disagree. Partial equivalence queries are always accepted, so that
+     * every round ends with a hypothesis built from the behaviour graph.
+     */
+    class enumerating_teacher : public automaton_teacher {
+    public:
+        enumerating_teacher(R1CA &ref, size_t max_length) : automaton_teacher(ref), ref_(ref) {
+            // Words the reference can count, since every prefix of a counter-example gets a row
+            words_.emplace_back();
+            for (auto begin = 0ul; begin < words_.size() and words_[begin].size() < max_length; ++begin) {
+                for (auto symbol : ref.get_alphabet().symbols()) {
+                    if (ref.count(words_[begin] + symbol) >= 0)
+                        words_.push_back(words_[begin] + symbol);
+                }
+            }
+        }
+
+        std::optional<std::string> partial_equivalence_query(behaviour_graph &, const std::string &) override {
+            return std::nullopt;
+        }
+
+        std::optional<std::string> equivalence_query(one_counter_automaton &automaton, const std::string &) override {
+            ++equivalence_queries_n;
+            auto &hypothesis = dynamic_cast<R1CA &>(automaton);
+            for (const auto &word : words_) {
+                if (hypothesis.evaluate(word) != ref_.evaluate(word))
+                    return word;
+            }
+
+            return std::nullopt;
+        }
+
+        size_t equivalence_queries_n = 0;
+
+    private:
+        R1CA &ref_;
+        std::vector<std::string> words_;
+    };
+
+    /**
+     * a^n b^n, n > 0. The learner gives every symbol a single counter effect, so the reference does too: a always
+     * increments and b decrements, words leaving the language going to the sink 2
+     */
+    R1CA anbn_ref(basic_alphabet_t &alphabet) {
+        auto transitions = R1CA::transition_func_t();
+        transitions.assign(0, 'a', 0, R1CA::transition_func_t::unbounded, {0, 1});
+        transitions.assign(0, 'b', 1, R1CA::transition_func_t::unbounded, {1, -1});
+        transitions.assign(1, 'a', 0, R1CA::transition_func_t::unbounded, {2, 1});
+        transitions.assign(1, 'b', 1, R1CA::transition_func_t::unbounded, {1, -1});
+        transitions.assign(2, 'a', 0, R1CA::transition_func_t::unbounded, {2, 1});
+        transitions.assign(2, 'b', 1, R1CA::transition_func_t::unbounded, {2, -1});
+
+        return R1CA::from_scratch(0, 3, 1, {1}, transitions, alphabet);
+    }
+}
+
+/**
+ * Learn a R1CA over several rounds, counter-examples bringing rows of low levels once higher levels exist,
+ * and check the hypothesis on every word up to a length.
+ * Usage: v1c2al_r1ca_learning_check [max_length = 12]
+ */
+int main(int argc, char **argv) {
+    auto max_length = (argc > 1) ? std::stoul(argv[1]) : 12ul;
+    auto alphabet = basic_alphabet_t({'a', 'b'});
+    auto ref = anbn_ref(alphabet);
+    auto teacher = enumerating_teacher(ref, max_length);
+    auto learner = active_learning::learner(teacher, alphabet);
+
+    // The learner prints its progress, only the result goes to the standard output
+    auto report = std::ostream(std::cout.rdbuf());
+    auto silenced = std::stringstream();
+    auto *standard_output = std::cout.rdbuf(silenced.rdbuf());
+
+    auto res = learner.learn_R1CA(false);
+    std::cout.rdbuf(standard_output);
+
+    auto mismatch = teacher.equivalence_query(res, "");
+    report << "a^n b^n learned in " << teacher.equivalence_queries_n - 1 << " equivalence queries, "
+           << (mismatch ? "wrong on '" + *mismatch + "'" : "right on every word up to length "
+                                                          + std::to_string(max_length)) << std::endl;
+    return mismatch ? 1 : 0;
+}
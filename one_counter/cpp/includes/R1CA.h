@@ -2,8 +2,10 @@
 
 #include "one_counter_automaton.h"
 #include "utils.h"
+#include "guarded_transitions.h"
 
 #include <string>
+#include <vector>
 
 namespace active_learning {
 
@@ -12,10 +14,12 @@ namespace active_learning {
         struct transition_y {
             size_t state;
             int effect;
+
+            bool operator==(const transition_y &other) const;
         };
 
         using couples_t = std::vector<std::pair<std::string, std::string>>;
-        using transition_func_t = std::map<transition_x, transition_y>;
+        using transition_func_t = guarded_transitions<transition_y>;
         using transition_t = std::pair<size_t, size_t>;
 
     private:
@@ -28,6 +32,8 @@ namespace active_learning {
 
         int count(const std::string &word) const;
 
+        [[nodiscard]] std::vector<int> count_prefixes(const std::string &word) const;
+
         [[nodiscard]]
         const basic_alphabet_t &get_alphabet() const;
 
@@ -46,6 +52,10 @@ namespace active_learning {
         [[nodiscard]]
         bool is_final(size_t state) const;
 
+        friend void write_model(const R1CA &automaton, const std::string &path);
+
+        friend class writer;
+
         static R1CA
         from_scratch(size_t initState, size_t statesN, size_t maxLvl,
                      const std::set<size_t> &finalStates, const transition_func_t &transitions,
@@ -4,9 +4,12 @@
 #include "displayable.h"
 #include "alphabet.h"
 #include "utils.h"
+#include "config_map.h"
+#include "guarded_transitions.h"
 
 #include <string>
 #include <optional>
+#include <string_view>
 #include <iostream>
 #include <boost/graph/adjacency_list.hpp>
 
@@ -33,24 +36,45 @@ namespace active_learning {
             std::string name;
         };
 
-        using transition_func_t = std::map<one_counter_automaton::transition_x, V1CA::transition_y>;
+        // Algorithm used to decide the equivalence of two V1CA
+        enum class equivalence_engine {
+            product,            // On-the-fly exploration of the synchronized product
+            union_find          // Hopcroft-Karp union-find over configurations, for deterministic V1CA
+        };
+
+        using transition_func_t = guarded_transitions<V1CA::transition_y>;
+        using guard_t = transition_func_t::guard_t;
         using couples_t = std::vector<std::pair<state_t, state_t>>;
 
     private:
-        std::optional<std::string> empty_(std::set<state_t> &visited, state_t curr, std::string curr_word) const;
+        // Where a configuration was first reached from during a search
+        struct config_parent_t {
+            uint64_t config;
+            char symbol;
+        };
+
+        const transition_y *step(state_t from, size_t cv, char symbol) const;
+
+        size_t config_bound() const;
+
+        static std::string rebuild_witness(const config_map<config_parent_t> &parents, uint64_t config,
+                                           uint64_t init_config);
+
+        static uint64_t difference_bound_(const V1CA &left, const V1CA &right);
+
+        static std::optional<std::string> find_difference_(const V1CA &left, const V1CA &right, bool symmetric);
 
-        static void inter_with_(const V1CA &automaton1, const V1CA &automaton2,
-                                std::set<V1CA::state_t> &visited1,
-                                std::set<V1CA::state_t> &visited2,
-                                std::map<V1CA::state_t, V1CA::state_t> &auto1_state_to_res_state,
-                                V1CA::state_t curr1, V1CA::state_t curr2,
-                                V1CA &res, V1CA::state_t res_curr) ;
+        static std::optional<std::string> find_difference_union_find_(const V1CA &left, const V1CA &right);
 
-        std::vector<std::pair<transition_x, transition_y>> get_out_trans(state_t) const;
+        std::vector<std::pair<char, guard_t>> get_out_trans(state_t) const;
+
+        static std::vector<guard_t> effective_guards(const transition_func_t::guards_t &guards, size_t max_level);
+
+        std::vector<state_t> get_reachable_states() const;
 
         bool add_transition(const transition_x &x, const transition_y &y);
 
-        void increase_max_level();
+        bool add_transition(state_t from, char symbol, size_t lo, size_t hi, const transition_y &y);
 
     public:
         // Constructors
@@ -71,18 +95,30 @@ namespace active_learning {
 
         std::optional<std::string> empty() const;
 
-        std::optional<std::string> is_equivalent_to(V1CA &other) const;
+        std::optional<std::string> is_equivalent_to(V1CA &other,
+                                                    equivalence_engine engine = equivalence_engine::product) const;
 
         std::optional<std::string> is_subset_of(const V1CA &other) const;
 
         bool accepts(const std::string &word) const;
 
+        V1CA minimize() const;
+
         // Display
         void display(const std::string &path) override;
 
         friend class writer;
 
-        friend V1CA read_v1ca_from_file(const std::string &path, const visibly_alphabet_t &alphabet);
+        friend V1CA read_v1ca_from_buffer(std::string_view text, const visibly_alphabet_t &alphabet,
+                                          const std::string &source);
+
+        friend void write_model(const V1CA &automaton, const std::string &path);
+
+        friend class model_view;
+
+        friend class lifted_v1ca;
+
+        friend class v1ca_behaviour_view;
 
         // Modifiers
         void link_and_color_edges(couples_t &couples);
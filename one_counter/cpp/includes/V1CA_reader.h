@@ -2,7 +2,30 @@
 
 #include "V1CA.h"
 
+#include <string>
+#include <stdexcept>
+#include <string_view>
+
 namespace active_learning {
 
+    /**
+     * Syntax or consistency error in a .v1ca file, with the position (starting at 1) where it was found
+     */
+    class v1ca_parse_error : public std::runtime_error {
+    public:
+        v1ca_parse_error(const std::string &source, size_t line, size_t column, const std::string &message);
+
+        [[nodiscard]] size_t line() const;
+
+        [[nodiscard]] size_t column() const;
+
+    private:
+        size_t line_;
+        size_t column_;
+    };
+
     V1CA read_v1ca_from_file(const std::string &path, const visibly_alphabet_t &alphabet);
+
+    V1CA read_v1ca_from_buffer(std::string_view text, const visibly_alphabet_t &alphabet,
+                               const std::string &source = "<buffer>");
 }
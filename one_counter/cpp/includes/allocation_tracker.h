@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace active_learning {
+
+    /**
+     * Accounting of the heap memory used by a learning run, per phase and per subsystem (the part of a phase
+     * name before "::"). Allocations are counted by replacing the global operator new and delete, which is only
+     * done in builds where V1C2AL_ALLOC_TRACKING is defined: phases are the ones of the V1C2AL_TRACE_SPAN
+     * macro, and the learner adds the footprint of its structures after each round.
+     * Allocations made out of any phase are counted in the "(none)" phase.
+     */
+    class allocation_tracker {
+    public:
+        struct phase_stats {
+            std::string name;
+            size_t allocations = 0;
+            size_t bytes = 0;
+            // Highest number of bytes live in the whole program while the phase was the innermost one
+            size_t peak_live_bytes = 0;
+        };
+
+        struct round_stats {
+            size_t round = 0;
+            size_t rst_tables = 0;
+            size_t rst_cells = 0;
+            size_t rst_cell_bytes = 0;
+            size_t rst_label_bytes = 0;
+            size_t queries = 0;
+            size_t graph_vertices = 0;
+            size_t graph_edges = 0;
+            size_t live_bytes = 0;
+            size_t peak_live_bytes = 0;
+        };
+
+        static allocation_tracker &get_default();
+
+        // Whether allocations are counted at all, i.e. whether the build defines V1C2AL_ALLOC_TRACKING
+        static bool is_enabled();
+
+        [[nodiscard]] std::vector<phase_stats> get_phases() const;
+
+        [[nodiscard]] std::vector<phase_stats> get_subsystems() const;
+
+        [[nodiscard]] size_t get_live_bytes() const;
+
+        [[nodiscard]] size_t get_peak_live_bytes() const;
+
+        void reset_peak();
+
+        void add_round(round_stats round);
+
+        [[nodiscard]] std::vector<round_stats> get_rounds() const;
+
+        void write_summary(const std::string &path) const;
+
+    private:
+        mutable std::mutex mutex_;
+        std::vector<round_stats> rounds_;
+    };
+
+    // Phase allocations of the calling thread are counted in, for the lifetime of the object
+    class allocation_scope {
+    public:
+        explicit allocation_scope(const char *phase);
+
+        allocation_scope(const allocation_scope &) = delete;
+
+        allocation_scope &operator=(const allocation_scope &) = delete;
+
+        ~allocation_scope();
+
+    private:
+        uint32_t parent_;
+    };
+}
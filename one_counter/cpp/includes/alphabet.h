@@ -4,6 +4,8 @@
 
 #include <set>
 #include <map>
+#include <array>
+#include <vector>
 
 namespace active_learning {
 
@@ -27,6 +29,11 @@ namespace active_learning {
 
     class visibly_alphabet : public alphabet, public word_counter {
     public:
+        struct cv_summary {
+            int cv;         // Counter value of the whole word
+            int min_cv;     // Lowest counter value reached by a prefix of the word (including "")
+        };
+
         explicit visibly_alphabet(const std::map<char, int> &symbolsAndValues);
 
         visibly_alphabet();
@@ -37,6 +44,10 @@ namespace active_learning {
 
         int get_cv(const std::string &word) const override;
 
+        std::vector<int> get_prefixes_cv(const std::string &word) const override;
+
+        cv_summary get_cv_summary(const std::string &word, std::vector<int> *prefixes_cv = nullptr) const;
+
         [[nodiscard]] const std::set<char> &symbols() const override;
 
         bool operator==(const visibly_alphabet &other) const;
@@ -44,6 +55,9 @@ namespace active_learning {
     private:
         std::set<char> symbols_;
         std::map<char, int> symbols_and_values_;
+        // Lookup tables indexed by the symbol as an unsigned char
+        std::array<int, 256> cv_table_{};
+        std::array<bool, 256> known_{};
     };
 
     // Aliases
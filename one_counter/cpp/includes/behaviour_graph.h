@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <string>
+#include <unordered_map>
 #include <boost/graph/adjacency_list.hpp>
 #include "V1CA.h"
 #include "R1CA.h"
@@ -11,12 +13,22 @@ namespace active_learning {
 
     class teacher;
 
+    class v1ca_behaviour_view;
+
     struct bg_vertex_attr {
+        static constexpr unsigned char init_flag = 1;
+        static constexpr unsigned char final_flag = 2;
+
         std::string name;
         int level{};
+        // Stable through vertex deletions, unlike the vertex descriptor
+        size_t id{};
+        unsigned char flags = 0;
 
         bg_vertex_attr(const std::string &name, int level);
 
+        bg_vertex_attr(const std::string &name, int level, size_t id, unsigned char flags);
+
         bg_vertex_attr();
     };
 
@@ -36,48 +48,148 @@ namespace active_learning {
         using graph_t = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, bg_vertex_attr, bg_edge_attr>;
         using vertex_descriptor_t = typename boost::graph_traits<graph_t>::vertex_descriptor;
         using edge_descriptor_t = typename boost::graph_traits<graph_t>::edge_descriptor;
-        using couples_t = std::vector<std::pair<std::string, std::string>>;
+        // Couples of vertex ids (see bg_vertex_attr::id)
+        using couples_t = std::vector<std::pair<size_t, size_t>>;
+
+        // What the last period search of to_v1ca() or to_r1ca() went through
+        struct period_search_stats {
+            size_t candidates = 0;      // (m, k) couples fitting in the graph
+            size_t pruned = 0;          // Candidates rejected by level signatures
+            size_t checked = 0;         // Candidates that went through an isomorphism check
+            size_t threads = 0;
+            double elapsed_ms = 0;
+        };
+
+        /**
+         * Read-only view of the vertices of a graph whose level is in [level_down, level_top], and of the edges
+         * between them. Vertices of the view are numbered from 0, by increasing level, and are a slice of the
+         * level buckets of the graph, so nothing is copied. The graph must outlive the view and not be modified.
+         */
+        class level_range {
+        public:
+            level_range(const behaviour_graph &graph, size_t level_down, size_t level_top);
+
+            [[nodiscard]] size_t vertices_n() const;
+
+            // Vertex of the graph of a vertex of the view
+            [[nodiscard]] vertex_descriptor_t vertex(size_t v) const;
+
+            // Vertex of the view of a vertex of the graph, std::nullopt if it is out of the range
+            [[nodiscard]] std::optional<size_t> local(vertex_descriptor_t v) const;
+
+            [[nodiscard]] std::optional<size_t> get_next_vertex(size_t from, char c) const;
+
+            [[nodiscard]] std::vector<size_t> get_prev_vertices(size_t to, char c) const;
+
+            [[nodiscard]] bool is_final(size_t v) const;
+
+            [[nodiscard]] bool is_init(size_t v) const;
+
+            [[nodiscard]] size_t level(size_t v) const;
+
+            [[nodiscard]] size_t id(size_t v) const;
+
+            [[nodiscard]] const std::string &name(size_t v) const;
+
+        private:
+            const behaviour_graph &graph_;
+            // Slice of graph_.level_order_
+            size_t begin_;
+            size_t end_;
+        };
     private:
         using edges_t = std::vector<std::tuple<std::string, char, int, std::string>>;
         using vertexes_t = std::vector<std::pair<std::string, int>>;
-        using new_edges_t = one_counter_automaton::new_edges_t;
-        using label_map_t = std::map<unsigned long int, vertex_descriptor_t>;
-        using states_t = std::vector<vertex_descriptor_t>;
+
+        // Below this many successor words, get_edges_from_rst() resolves them without spawning threads
+        static constexpr size_t parallel_words_min = 4096;
+
+        // Compressed sparse row copy of the edges of graph_, with direct successor and predecessor tables.
+        // Edges of a vertex are stored contiguously, in the order of boost::out_edges (resp. of boost::edges
+        // for incoming edges), and tables are indexed by vertex * symbols_n + symbol_index[symbol].
+        struct csr_t {
+            static constexpr vertex_descriptor_t none = SIZE_MAX;
+
+            std::vector<size_t> out_offsets;
+            std::vector<vertex_descriptor_t> out_targets;
+            std::vector<char> out_symbols;
+            std::vector<size_t> in_offsets;
+            std::vector<vertex_descriptor_t> in_sources;
+            std::vector<char> in_symbols;
+            std::array<int, 256> symbol_index{};
+            size_t symbols_n = 0;
+            std::vector<vertex_descriptor_t> next;
+            std::vector<vertex_descriptor_t> prev;
+        };
 
     private:
-        edge_descriptor_t find_edge(vertex_descriptor_t src, vertex_descriptor_t dst);
+        void freeze();
 
         vertex_descriptor_t find_vertex_by_name(const std::string &name);
 
-        static edges_t
-        get_edges_from_rst(RST &rst, word_counter &wc, vertexes_t &states, teacher &teacher, alphabet &alphabet);
+        vertex_descriptor_t vertex_of(size_t id) const;
 
-        static std::string find_state_from_word(RST &rst, const std::string &state_word, int cv, teacher &teacher);
+        edges_t get_edges_from_rst(const RST &rst, word_counter &wc, const std::set<size_t> &sources, teacher &teacher,
+                                   alphabet &alphabet);
 
-        std::set<edge_descriptor_t> get_edges_from_state(vertex_descriptor_t state);
+        size_t find_state_from_word(const RST &rst, const std::string &state_word, int cv) const;
 
-        // Deprecated because result of this is incompatible with to_v1ca() and to_r1ca()
-        new_edges_t link_period(couples_t &couples);
+        const std::vector<bool> &get_row_of_word(const RST &rst, const std::string &word, int cv) const;
 
-        V1CA::couples_t to_v1ca_couple(couples_t couples);
+        void query_missing_rows(const RST &rst, const std::vector<std::vector<std::string>> &words_per_level,
+                                teacher &teacher);
 
-        void delete_high_levels(unsigned int threshold_level);
+        void classify_row(const RST &rst, int cv, size_t row_i, std::set<size_t> &dirty);
 
-        behaviour_graph get_subgraph(unsigned int level_down, unsigned int level_top);
+        // What was already applied of the journal of the RST the graph is maintained from (see update())
+        struct rst_sync_t {
+            size_t journal_pos = 0;
+            // Per table, the vertex id of each class of rows, a class being the values of its rows
+            std::vector<std::unordered_map<std::vector<bool>, size_t>> classes;
+            // Per table, the index of the first row with each label
+            std::vector<std::unordered_map<std::string, size_t>> rows;
+            // Values of the words that are successors of vertices but not rows of the RST, on the columns of their
+            // table. They are only extended when columns are added.
+            std::unordered_map<std::string, std::vector<bool>> probes;
+            // Ids of the vertices having a successor above the top table of the RST
+            std::set<size_t> below_top;
+        };
 
         std::optional<couples_t> find_period(unsigned int level, unsigned int width, alphabet &alphabet);
 
-        bool is_isomorphic_to_(behaviour_graph &other, states_t &states1, states_t &states2, couples_t &res,
-                               label_map_t &label_map, alphabet &alphabet);
+        // A period of width k starting at level m, with the couples of matching states of levels m and m + k
+        struct period_t {
+            unsigned int m;
+            unsigned int k;
+            couples_t couples;
+        };
+
+        // Cheap summary of a level, equal for the matching levels of isomorphic level subgraphs
+        struct level_signature_t {
+            size_t vertices = 0;
+            size_t finals = 0;
+            // Number of edges per symbol, going up to the next level, staying on the level, or going down
+            std::map<char, size_t> up;
+            std::map<char, size_t> same;
+            std::map<char, size_t> down;
+        };
 
-        states_t get_all_states_of_level(unsigned int level);
+        std::vector<level_signature_t> get_level_signatures();
 
-        bool is_state_isomorphic(behaviour_graph &other, vertex_descriptor_t state1, vertex_descriptor_t state2,
-                                 label_map_t &, alphabet &);
+        std::optional<period_t> search_period(alphabet &alphabet);
 
-        std::optional<vertex_descriptor_t> get_next_vertex(vertex_descriptor_t from, char c);
+        void print_period_search_stats() const;
 
-        std::optional<vertex_descriptor_t> get_prev_vertex(vertex_descriptor_t to, char c);
+        template<class Left, class Right>
+        static std::optional<couples_t> find_isomorphism_(const Left &left, const Right &right,
+                                                          unsigned int from_level1, unsigned int from_level2,
+                                                          alphabet &alphabet);
+
+        std::optional<vertex_descriptor_t> get_next_vertex(vertex_descriptor_t from, char c) const;
+
+        std::optional<vertex_descriptor_t> get_prev_vertex(vertex_descriptor_t to, char c) const;
+
+        std::vector<vertex_descriptor_t> get_prev_vertices(vertex_descriptor_t to, char c) const;
 
 
     public:
@@ -90,36 +202,73 @@ namespace active_learning {
 
         behaviour_graph(RST &rst, word_counter &wc, teacher &teacher, alphabet &alphabet);
 
+        void update(RST &rst, word_counter &wc, teacher &teacher, alphabet &alphabet);
+
         void display(const std::string &path) override;
 
+        // The graph must not be modified through this, as lookups rely on an index built from it
         graph_t &get_mutable_graph();
 
-        std::shared_ptr<V1CA> to_v1ca(RST &rst_no_dup, visibly_alphabet_t &alphabet, bool verbose);
+        std::shared_ptr<V1CA> to_v1ca(RST &rst, visibly_alphabet_t &alphabet, bool verbose);
 
         V1CA to_v1ca_direct(visibly_alphabet_t &alphabet);
 
-        std::shared_ptr<R1CA> to_r1ca(RST &rst_no_dup, basic_alphabet &alphabet, bool verbose);
+        V1CA to_v1ca_direct(visibly_alphabet_t &alphabet, const level_range &range);
+
+        std::shared_ptr<R1CA> to_r1ca(RST &rst, basic_alphabet &alphabet, bool verbose);
 
         R1CA to_r1ca_direct(basic_alphabet &alphabet);
 
-        R1CA to_r1ca_direct(basic_alphabet &alphabet,
-                            const new_edges_t &new_edges,
-                            size_t new_edge_lvl);
+        R1CA to_r1ca_direct(basic_alphabet &alphabet, const level_range &range, const couples_t &couples,
+                            size_t period_level, size_t max_level);
+
+        bool is_final(const std::string &v_name) const;
+
+        bool is_init(const std::string &v_name) const;
+
+        bool is_final(vertex_descriptor_t v) const;
+
+        bool is_init(vertex_descriptor_t v) const;
 
-        bool is_final(const std::string &v_name);
+        const std::string &name(vertex_descriptor_t v) const;
 
-        bool is_init(const std::string &v_name);
+        size_t id(vertex_descriptor_t v) const;
+
+        size_t level(vertex_descriptor_t v) const;
+
+        size_t vertices_n() const;
+
+        size_t edges_n() const;
 
         std::optional<behaviour_graph::couples_t>
         is_isomorphic_to(behaviour_graph &other, unsigned int from_level1, unsigned int from_level2,
                          alphabet &alphabet);
 
+        std::optional<behaviour_graph::couples_t>
+        is_isomorphic_to(const v1ca_behaviour_view &other, unsigned int from_level1, unsigned int from_level2,
+                         alphabet &alphabet);
+
+        std::optional<std::string> find_difference_up_to_level(const v1ca_behaviour_view &reference);
+
         static behaviour_graph from_v1ca(const V1CA &v1ca);
 
+        [[nodiscard]] const period_search_stats &get_period_search_stats() const;
+
     private:
         graph_t graph_;
-        std::string init_state_;
-        std::unordered_set<std::string> final_states_;
+        csr_t csr_;
+        // Only used for lookups by name, vertices being identified by their id
+        std::unordered_map<std::string, size_t> name_to_id_;
+        // Rebuilt by freeze(), csr_t::none for the ids of deleted vertices
+        std::vector<vertex_descriptor_t> id_to_vertex_;
+        vertex_descriptor_t init_vertex_ = csr_t::none;
+        // Level buckets, rebuilt by freeze(): vertices sorted by level (then by descriptor), the index in
+        // level_order_ of the first vertex of each level, and the index of each vertex in level_order_
+        std::vector<vertex_descriptor_t> level_order_;
+        std::vector<size_t> level_offsets_;
+        std::vector<size_t> level_rank_;
         size_t max_level_ = 0;
+        period_search_stats period_stats_;
+        rst_sync_t rst_sync_;
     };
 }
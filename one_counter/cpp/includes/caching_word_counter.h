@@ -0,0 +1,55 @@
+#pragma once
+
+#include "word_counter.h"
+
+#include <array>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace active_learning {
+
+    /**
+     * Decorator of a word_counter remembering the counter values it already computed.
+     * Values are stored in a trie of the words asked, so that a word shares its nodes with its prefixes:
+     * counting a word also memoizes every one of its prefixes, using a single get_prefixes_cv() of the
+     * decorated counter. The effect of single symbols is cached separately in a table.
+     * The cache is not thread safe, and the decorated counter must outlive it.
+     */
+    class caching_word_counter : public word_counter {
+    public:
+        explicit caching_word_counter(const word_counter &counter);
+
+        int get_cv(const std::string &word) const override;
+
+        int get_cv(char symbol) const;
+
+        std::vector<int> get_prefixes_cv(const std::string &word) const override;
+
+        [[nodiscard]] size_t hits() const;
+
+        [[nodiscard]] size_t misses() const;
+
+        [[nodiscard]] double hit_rate() const;
+
+        [[nodiscard]] std::string sum_up_msg() const;
+
+    private:
+        static constexpr int unknown = std::numeric_limits<int>::min();
+
+        struct trie_node {
+            int cv = unknown;
+            std::map<char, size_t> children;
+        };
+
+        std::vector<int> memoize(const std::string &word) const;
+
+        const word_counter &counter_;
+        mutable std::vector<trie_node> trie_;
+        mutable std::array<int, 256> symbol_cv_{};
+        mutable std::array<bool, 256> symbol_known_{};
+        mutable size_t hits_ = 0;
+        mutable size_t misses_ = 0;
+    };
+}
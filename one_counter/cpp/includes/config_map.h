@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace active_learning {
+
+    /**
+     * Open-addressing hash map from packed configurations (state(s) and counter value as a single integer)
+     * to a small value, used to remember visited configurations during automata explorations.
+     * Keys are stored in a flat array with linear probing, UINT64_MAX is reserved as the empty key.
+     */
+    template<class Value>
+    class config_map {
+    public:
+        explicit config_map(size_t expected = 64) {
+            auto capacity = 16ul;
+            while (capacity < 2 * expected)
+                capacity *= 2;
+            keys_.assign(capacity, empty_key);
+            values_.resize(capacity);
+        }
+
+        /**
+         * Insert a value if the key is not present yet
+         * @return true if the value was inserted, false if the key was already present
+         */
+        bool insert(uint64_t key, const Value &value) {
+            if (2 * (size_ + 1) > keys_.size())
+                grow();
+
+            auto i = slot(key);
+            if (keys_[i] == key)
+                return false;
+
+            keys_[i] = key;
+            values_[i] = value;
+            ++size_;
+            return true;
+        }
+
+        const Value *find(uint64_t key) const {
+            auto i = slot(key);
+            return (keys_[i] == key) ? &values_[i] : nullptr;
+        }
+
+        bool contains(uint64_t key) const {
+            return find(key) != nullptr;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return size_;
+        }
+
+    private:
+        static constexpr uint64_t empty_key = UINT64_MAX;
+
+        size_t slot(uint64_t key) const {
+            // Fibonacci hashing, spreads consecutive configurations
+            const auto mask = keys_.size() - 1;
+            auto i = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 17) & mask;
+            while (keys_[i] != empty_key and keys_[i] != key)
+                i = (i + 1) & mask;
+
+            return i;
+        }
+
+        void grow() {
+            auto old_keys = std::move(keys_);
+            auto old_values = std::move(values_);
+            keys_.assign(2 * old_keys.size(), empty_key);
+            values_.assign(2 * old_values.size(), Value());
+
+            for (auto i = 0u; i < old_keys.size(); ++i) {
+                if (old_keys[i] != empty_key) {
+                    auto new_i = slot(old_keys[i]);
+                    keys_[new_i] = old_keys[i];
+                    values_[new_i] = old_values[i];
+                }
+            }
+        }
+
+        std::vector<uint64_t> keys_;
+        std::vector<Value> values_;
+        size_t size_ = 0;
+    };
+}
@@ -51,9 +51,23 @@ namespace active_learning {
             std::vector<std::vector<bool>> data_;
         };
 
+        // A change made to the RST: a table added at the top, or a row or column appended to the table of
+        // counter value cv, at the given index
+        struct change {
+            enum class kind { table, row, col };
+
+            kind what;
+            int cv;
+            size_t index;
+        };
+
     private:
+        RST() = default;
+
         void expand_RST(int cv);
 
+        void rebuild_journal();
+
         static std::vector<std::string> get_all_prefixes(const std::string &word);
 
     public:
@@ -61,6 +75,8 @@ namespace active_learning {
 
         RST remove_duplicate_rows() const;
 
+        [[nodiscard]] RST copy_tables() const;
+
         void add_row(const std::string &name, int cv);
 
         void add_col(const std::string &name, int cv);
@@ -86,12 +102,32 @@ namespace active_learning {
 
         size_t size() const;
 
+        [[nodiscard]] size_t rows_n() const;
+
+        [[nodiscard]] size_t cols_n() const;
+
+        [[nodiscard]] size_t cells_n() const;
+
+        [[nodiscard]] size_t cells_bytes() const;
+
+        [[nodiscard]] size_t labels_bytes() const;
+
         std::vector<RST_table> &get_tables();
 
         const std::vector<RST_table> &get_ctables() const;
 
+        const std::vector<change> &get_journal() const;
+
+        [[nodiscard]] size_t journal_begin() const;
+
+        void trim_journal(size_t pos);
+
     private:
         std::vector<RST_table> tables_;
+        // Changes made to the tables through the RST, in order, from the position journal_begin_ on: the ones
+        // before it were trimmed once applied. Changes made through get_tables() are not recorded.
+        std::vector<change> journal_;
+        size_t journal_begin_ = 0;
     };
 
     std::ostream &operator<<(std::ostream &out, const RST &rst);
@@ -5,54 +5,84 @@
 #include "behaviour_graph.h"
 #include "alphabet.h"
 
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+
 namespace active_learning {
 
-    class writer {
+    /**
+     * Buffer DOT text is written to. It either grows in memory, to be released as a whole, or streams to a file,
+     * being written to it whenever it is full and when it is destroyed.
+     */
+    class dot_buffer {
 
     public:
-        static void write_v1ca(std::ostream &out, V1CA& automaton);
-    };
+        dot_buffer() = default;
 
-    // Used for graphviz dot vertex output
-    class vertex_writer {
+        explicit dot_buffer(const std::string &path);
 
-    public:
-        explicit vertex_writer(displayable &display_obj);
+        ~dot_buffer();
+
+        dot_buffer &operator<<(std::string_view text) {
+            buffer_.append(text);
+            flush_if_full();
+            return *this;
+        }
 
-        void write_behaviour_graph(std::ostream &out, const behaviour_graph::vertex_descriptor_t &v);
+        dot_buffer &operator<<(char c) {
+            buffer_.push_back(c);
+            flush_if_full();
+            return *this;
+        }
 
-        template<class Vertex>
-        void operator()(std::ostream &out, const Vertex &v) {
+        template<std::integral Integer>
+        dot_buffer &operator<<(Integer value) {
+            char digits[24];
+            auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+            buffer_.append(digits, end);
+            flush_if_full();
+            return *this;
+        }
+
+        [[nodiscard]] const std::string &str() const {
+            return buffer_;
+        }
 
-            if (to_display_.get_displayable_type() == displayable_type::behaviour_graph) {
-                write_behaviour_graph(out, static_cast<behaviour_graph::vertex_descriptor_t>(v));
-            } else {
-                throw std::invalid_argument("Cannot display edge for this type of automaton.");
-            }
+        std::string release() {
+            return std::move(buffer_);
         }
 
+        void flush();
+
     private:
-        displayable &to_display_;
+        static constexpr size_t flush_size = 1 << 16;
+
+        void flush_if_full() {
+            if (file_.is_open() and buffer_.size() >= flush_size)
+                flush();
+        }
+
+        std::string buffer_;
+        std::ofstream file_;
+    };
+
+    // Counter values to be exported: states of other levels are left out, and guards are cut to the window
+    struct dot_window {
+        size_t level_down = 0;
+        size_t level_top = SIZE_MAX;
     };
 
-    // Used for graphviz dot edge output
-    class edge_writer {
+    class writer {
 
     public:
-        explicit edge_writer(displayable &display_obj) : to_display_(display_obj) {}
+        static void write_v1ca(dot_buffer &out, V1CA &automaton, const dot_window &window = {});
 
-        void write_behaviour_graph(std::ostream &out, const behaviour_graph::edge_descriptor_t &e);
+        static void write_r1ca(dot_buffer &out, R1CA &automaton, const dot_window &window = {});
 
-        template<class Edge>
-        void operator()(std::ostream &out, const Edge &e) {
-            if (to_display_.get_displayable_type() == displayable_type::behaviour_graph) {
-                write_behaviour_graph(out, static_cast<behaviour_graph::edge_descriptor_t>(e));
-            } else {
-                throw std::invalid_argument("Cannot display edge for this type of object.");
-            }
-        }
-
-    private:
-        displayable &to_display_;
+        static void write_behaviour_graph(dot_buffer &out, behaviour_graph &bg);
     };
 }
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+namespace active_learning {
+
+    /**
+     * Transition function of a one-counter automaton, keyed by (state, symbol). Each key holds a sorted list of
+     * disjoint counter guards [lo, hi] (hi being unbounded for "counter >= lo"), so the memory used depends on
+     * the number of distinct behaviours and not on the number of levels.
+     * Adjacent guards leading to the same target are merged.
+     */
+    template<class Target>
+    class guarded_transitions {
+    public:
+        static constexpr size_t unbounded = SIZE_MAX;
+
+        struct guard_t {
+            size_t lo;
+            size_t hi;
+            Target target;
+
+            [[nodiscard]] bool contains(size_t cv) const {
+                return lo <= cv and cv <= hi;
+            }
+        };
+
+        using guards_t = std::vector<guard_t>;
+        using key_t = std::pair<size_t, char>;
+        using map_t = std::map<key_t, guards_t>;
+
+        /**
+         * Find the transition taken from a state with a symbol and a counter value, with a binary search on guards
+         * @return The target of the transition, nullptr if there is none
+         */
+        const Target *find(size_t state, char symbol, size_t cv) const {
+            auto found = transitions_.find({state, symbol});
+            if (found == transitions_.end())
+                return nullptr;
+
+            const auto &guards = found->second;
+            // First guard starting after cv, the candidate is the one before
+            auto after = std::upper_bound(guards.begin(), guards.end(), cv,
+                                          [](size_t value, const guard_t &guard) { return value < guard.lo; });
+            if (after == guards.begin() or std::prev(after)->hi < cv)
+                return nullptr;
+
+            return &std::prev(after)->target;
+        }
+
+        /**
+         * Add a transition on every counter value of [lo, hi], replacing the parts of the guards it overlaps
+         */
+        void assign(size_t state, char symbol, size_t lo, size_t hi, const Target &target) {
+            auto &guards = transitions_[{state, symbol}];
+
+            // Guards are usually added by increasing counter values
+            if (guards.empty() or (guards.back().hi != unbounded and guards.back().hi < lo)) {
+                if (not guards.empty() and guards.back().hi + 1 == lo and guards.back().target == target)
+                    guards.back().hi = hi;
+                else
+                    guards.push_back({lo, hi, target});
+                return;
+            }
+
+            auto res = guards_t();
+            res.reserve(guards.size() + 2);
+            auto added = false;
+            for (const auto &guard : guards) {
+                if (not added and guard.lo >= lo) {
+                    push_merged(res, {lo, hi, target});
+                    added = true;
+                }
+                if (guard.hi < lo or guard.lo > hi) {
+                    push_merged(res, guard);
+                    continue;
+                }
+                // Keeping the parts of the guard outside of [lo, hi]
+                if (guard.lo < lo)
+                    push_merged(res, {guard.lo, lo - 1, guard.target});
+                if (not added) {
+                    push_merged(res, {lo, hi, target});
+                    added = true;
+                }
+                if (hi != unbounded and guard.hi > hi)
+                    push_merged(res, {hi + 1, guard.hi, guard.target});
+            }
+            if (not added)
+                push_merged(res, {lo, hi, target});
+
+            guards = std::move(res);
+        }
+
+        /**
+         * Remove the transitions on every counter value of [lo, hi]
+         */
+        void erase(size_t state, char symbol, size_t lo = 0, size_t hi = unbounded) {
+            auto found = transitions_.find({state, symbol});
+            if (found == transitions_.end())
+                return;
+
+            auto res = guards_t();
+            for (const auto &guard : found->second) {
+                if (guard.hi < lo or guard.lo > hi) {
+                    res.push_back(guard);
+                    continue;
+                }
+                if (guard.lo < lo)
+                    res.push_back({guard.lo, lo - 1, guard.target});
+                if (hi != unbounded and guard.hi > hi)
+                    res.push_back({hi + 1, guard.hi, guard.target});
+            }
+
+            if (res.empty())
+                transitions_.erase(found);
+            else
+                found->second = std::move(res);
+        }
+
+        /**
+         * Tell whether a transition on [lo, hi] would replace a transition with a different target
+         */
+        [[nodiscard]] bool conflicts(size_t state, char symbol, size_t lo, size_t hi, const Target &target) const {
+            const auto *all = guards(state, symbol);
+            // Guards are usually added by increasing counter values
+            if (not all or (all->back().hi != unbounded and all->back().hi < lo))
+                return false;
+
+            return std::any_of(all->begin(), all->end(), [&](const guard_t &guard) {
+                return guard.lo <= hi and lo <= guard.hi and not (guard.target == target);
+            });
+        }
+
+        /**
+         * @return The guards of a (state, symbol), nullptr if there is none
+         */
+        [[nodiscard]] const guards_t *guards(size_t state, char symbol) const {
+            auto found = transitions_.find({state, symbol});
+            return (found == transitions_.end()) ? nullptr : &found->second;
+        }
+
+        // Iterating over ((state, symbol), guards), by increasing state then symbol
+        typename map_t::const_iterator begin() const {
+            return transitions_.begin();
+        }
+
+        typename map_t::const_iterator end() const {
+            return transitions_.end();
+        }
+
+        // Guards of a state are contiguous
+        typename map_t::const_iterator lower_bound(size_t state) const {
+            return transitions_.lower_bound({state, std::numeric_limits<char>::min()});
+        }
+
+        [[nodiscard]] size_t size() const {
+            auto res = 0ul;
+            for (const auto &entry : transitions_)
+                res += entry.second.size();
+
+            return res;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return transitions_.empty();
+        }
+
+    private:
+        static void push_merged(guards_t &guards, const guard_t &guard) {
+            if (not guards.empty() and guards.back().hi != unbounded and guards.back().hi + 1 == guard.lo
+                and guards.back().target == guard.target)
+                guards.back().hi = guard.hi;
+            else
+                guards.push_back(guard);
+        }
+
+        map_t transitions_;
+    };
+}
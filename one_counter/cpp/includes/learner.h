@@ -5,6 +5,9 @@
 #include "teachers/teacher.h"
 #include "dataframe.h"
 #include "teachers/automaton_teacher.h"
+#include "caching_word_counter.h"
+
+#include <memory>
 
 namespace active_learning {
 
@@ -14,6 +17,14 @@ namespace active_learning {
         R1CA
     };
 
+    // Size of the last learning, for benchmarks
+    struct learning_stats {
+        size_t rounds = 0;
+        size_t rst_tables = 0;
+        size_t rst_rows = 0;
+        size_t rst_cols = 0;
+    };
+
     class learner {
 
     private:
@@ -25,10 +36,10 @@ namespace active_learning {
 
         int get_cv(char symbol);
 
-        bool is_O_equivalent_(const std::string &word1, const std::string &word2, RST &rst);
-
         std::set<std::string> get_congruence_set_(const std::string &word, RST &rst);
 
+        void end_round(size_t round, const RST &rst, const behaviour_graph &bg);
+
     public:
         learner(teacher &teacher, alphabet &alphabet);
 
@@ -36,13 +47,18 @@ namespace active_learning {
 
         R1CA learn_R1CA(bool verbose = false);
 
+        [[nodiscard]] const learning_stats &get_stats() const;
+
     private:
         teacher &teacher_;
         alphabet &alphabet_;
         visibly_alphabet_t *as_visibly_alphabet_;
         basic_alphabet_t *as_basic_alphabet_;
         automaton_teacher *as_automaton_teacher_;
+        // Every counter value asked during learning goes through this cache
+        std::unique_ptr<caching_word_counter> counter_;
         learner_mode mode_ = learner_mode::UNINITIALIZED;
+        learning_stats stats_;
     };
 
 }
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "V1CA.h"
+
+#include <string>
+#include <vector>
+
+namespace active_learning {
+
+    /**
+     * Read-only view of a V1CA as if its max level was raised. Above its max level m, a V1CA behaves the same
+     * for every counter value, so raising it to M only unrolls the states of level m on the levels m to M:
+     * the lifted state (q, j) is the state q of level m reached with a counter value of m + j
+     * (at most m for j = 0, at least M for j = M - m). Once materialized, the counter is clipped to M, so a lifted
+     * state can also be reached with a higher counter value, and keeps the transitions of every value from its level up.
+     * Lifted states and their transitions are computed on demand from the original V1CA, nothing is copied.
+     * Lifted state ids are q + j * states_n, so states below the max level keep their ids.
+     */
+    class lifted_v1ca {
+    public:
+        using state_t = V1CA::state_t;
+        using guard_t = V1CA::guard_t;
+
+        lifted_v1ca(const V1CA &automaton, size_t max_level);
+
+        [[nodiscard]] size_t max_level() const;
+
+        [[nodiscard]] state_t init_state() const;
+
+        // Every lifted state id is lower than this bound
+        [[nodiscard]] size_t states_bound() const;
+
+        [[nodiscard]] bool is_final(state_t state) const;
+
+        [[nodiscard]] size_t level(state_t state) const;
+
+        [[nodiscard]] std::string name(state_t state) const;
+
+        [[nodiscard]] std::vector<guard_t> guards(state_t state, char symbol) const;
+
+        [[nodiscard]] const V1CA &base() const;
+
+        [[nodiscard]] V1CA to_v1ca() const;
+
+    private:
+        [[nodiscard]] bool is_top(state_t base_state) const;
+
+        [[nodiscard]] state_t lift(state_t base_state, size_t cv) const;
+
+        const V1CA &automaton_;
+        size_t max_level_;
+    };
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace active_learning {
+
+    /**
+     * Read-only memory mapping of a whole file, unmapped on destruction.
+     * An empty file is mapped as a null pointer with a size of 0.
+     */
+    class mapped_file {
+    public:
+        explicit mapped_file(const std::string &path);
+
+        mapped_file(const mapped_file &) = delete;
+
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        mapped_file(mapped_file &&other) noexcept;
+
+        mapped_file &operator=(mapped_file &&other) noexcept;
+
+        ~mapped_file();
+
+        [[nodiscard]] const char *data() const;
+
+        [[nodiscard]] size_t size() const;
+
+    private:
+        void unmap();
+
+        const char *data_ = nullptr;
+        size_t size_ = 0;
+    };
+}
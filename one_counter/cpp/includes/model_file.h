@@ -0,0 +1,115 @@
+#pragma once
+
+#include "V1CA.h"
+#include "R1CA.h"
+#include "mapped_file.h"
+
+#include <bit>
+#include <string>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace active_learning {
+
+    /*
+     * Binary model format, shared by V1CA and R1CA (version 1).
+     * Every section is 8 bytes aligned, so a mapped file can be used in place:
+     *  - header (model_header)
+     *  - levels: uint32_t[states_n], level of every state
+     *  - name offsets: uint32_t[states_n + 1], state i is named names[offsets[i], offsets[i + 1])
+     *  - names: the characters of every name, not null terminated
+     *  - finals: uint32_t[finals_n], sorted final states
+     *  - table: model_transition[states_n * (max_level + 1) * symbols_n], the transition of
+     *    (state, counter value, symbol) is at (state * (max_level + 1) + counter value) * symbols_n + symbol index
+     * Integers are stored in the byte order of the machine, which must be little-endian.
+     */
+    static_assert(std::endian::native == std::endian::little, "The binary model format is little-endian.");
+
+    enum class model_kind : uint8_t {
+        v1ca,
+        r1ca
+    };
+
+    struct model_header {
+        char magic[4];
+        uint16_t version;
+        model_kind kind;
+        uint8_t reserved;
+        uint32_t symbols_n;
+        uint32_t states_n;
+        uint32_t init_state;
+        uint32_t max_level;
+        uint32_t finals_n;
+        uint32_t padding;
+        uint64_t levels_offset;
+        uint64_t name_offsets_offset;
+        uint64_t names_offset;
+        uint64_t finals_offset;
+        uint64_t table_offset;
+        uint64_t file_size;
+        char symbols[256];          // Symbols by index
+        uint8_t symbol_index[256];  // Index of every symbol, model_no_symbol if not in the alphabet
+        int32_t effects[256];       // Counter effect of every symbol by index (V1CA only)
+    };
+
+    struct model_transition {
+        uint32_t state;             // model_no_state if there is no transition
+        int32_t data;               // Color of the transition for V1CA, counter effect for R1CA
+    };
+
+    static_assert(std::is_trivially_copyable_v<model_header> and sizeof(model_header) % 8 == 0);
+    static_assert(std::is_trivially_copyable_v<model_transition> and sizeof(model_transition) == 8);
+
+    inline constexpr char model_magic[4] = {'O', 'C', 'A', 'M'};
+    inline constexpr uint16_t model_version = 1;
+    inline constexpr uint32_t model_no_state = UINT32_MAX;
+    inline constexpr uint8_t model_no_symbol = UINT8_MAX;
+
+    void write_model(const V1CA &automaton, const std::string &path);
+
+    void write_model(const R1CA &automaton, const std::string &path);
+
+    /**
+     * Zero-copy reader of a binary model file. The file is mapped in memory and every accessor reads it in place,
+     * the transition table being used directly to run words.
+     */
+    class model_view {
+    public:
+        explicit model_view(const std::string &path);
+
+        [[nodiscard]] model_kind kind() const;
+
+        [[nodiscard]] size_t states_n() const;
+
+        [[nodiscard]] size_t max_level() const;
+
+        [[nodiscard]] size_t init_state() const;
+
+        [[nodiscard]] size_t level(size_t state) const;
+
+        [[nodiscard]] std::string_view name(size_t state) const;
+
+        [[nodiscard]] bool is_final(size_t state) const;
+
+        [[nodiscard]] const model_transition *step(size_t state, size_t cv, char symbol) const;
+
+        [[nodiscard]] bool accepts(const std::string &word) const;
+
+        [[nodiscard]] V1CA to_v1ca(const visibly_alphabet_t &alphabet) const;
+
+        [[nodiscard]] R1CA to_r1ca(basic_alphabet_t &alphabet) const;
+
+    private:
+        template<class T>
+        const T *section(uint64_t offset, uint64_t count) const;
+
+        mapped_file file_;
+        const model_header *header_ = nullptr;
+        const uint32_t *levels_ = nullptr;
+        const uint32_t *name_offsets_ = nullptr;
+        const char *names_ = nullptr;
+        const uint32_t *finals_ = nullptr;
+        const model_transition *table_ = nullptr;
+    };
+}
@@ -9,8 +9,11 @@ namespace active_learning {
     class automatic_v1ca_teacher : public cached_teacher {
     public:
 
+        // The engine decides equivalence queries. Partial queries compare the behaviour graph to the reference
+        // level by level, with behaviour_graph::find_difference_up_to_level(), whatever the engine.
         automatic_v1ca_teacher(V1CA &automatonRef,
-                               visibly_alphabet_t alphabet);
+                               visibly_alphabet_t alphabet,
+                               V1CA::equivalence_engine engine = V1CA::equivalence_engine::product);
 
         std::optional<std::string>
         partial_equivalence_query(behaviour_graph &behaviour_graph, const std::string &path) override;
@@ -25,9 +28,9 @@ namespace active_learning {
         static V1CA &oca_to_v1ca(one_counter_automaton &v1ca);
 
     private:
-        std::unique_ptr<behaviour_graph> behaviour_ref_ = nullptr;
         V1CA &automaton_ref_;
         visibly_alphabet_t alphabet_;
+        V1CA::equivalence_engine engine_;
     };
 
 }
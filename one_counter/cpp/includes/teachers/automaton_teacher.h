@@ -15,6 +15,8 @@ namespace active_learning {
 
         int count_query(const std::string &word) const;
 
+        std::vector<int> count_prefixes_query(const std::string &word) const;
+
         std::optional<std::string>
         partial_equivalence_query(behaviour_graph &behaviour_graph, const std::string &path) override;
 
@@ -24,6 +26,8 @@ namespace active_learning {
     private:
         int get_cv(const std::string &word) const override;
 
+        std::vector<int> get_prefixes_cv(const std::string &word) const override;
+
         static R1CA &oca_to_r1ca(one_counter_automaton &automaton);
 
     private:
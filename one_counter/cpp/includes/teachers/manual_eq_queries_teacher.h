@@ -4,6 +4,7 @@
 #include "language.h"
 #include "V1CA.h"
 #include "behaviour_graph.h"
+#include "visualization_sink.h"
 
 namespace active_learning {
 
@@ -24,6 +25,8 @@ namespace active_learning {
         std::optional<std::string>
         partial_equivalence_query(behaviour_graph &behaviour_graph, const std::string &path) override {
             behaviour_graph.display(path);
+            // The image must exist before the user is asked to look at it
+            visualization_sink::get_default().flush();
 
             std::cout << "Please check the behaviour graph (graph name should be " << path
                       << ".png) and give a counter example, or enter 'OK' if the graph is good ";
@@ -44,6 +47,7 @@ namespace active_learning {
         std::optional<std::string>
         equivalence_query(one_counter_automaton &automaton, const std::string &path) override {
             automaton.display(path);
+            visualization_sink::get_default().flush();
 
             std::cout << "Please check the V1CA automaton (automaton name should be " << path
                       << ".png) and give a counter example, or 'OK' if the automaton is good ";
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <optional>
+#include <vector>
 #include <map>
 
 #include "one_counter_automaton.h"
@@ -15,11 +16,15 @@ namespace active_learning {
     public:
         virtual bool membership_query(const std::string &word) = 0;
 
+        virtual std::vector<bool> membership_queries(const std::vector<std::string> &words);
+
         virtual std::optional<std::string>
         partial_equivalence_query(behaviour_graph &behaviour_graph, const std::string &path) = 0;
 
         virtual std::string sum_up_msg() const;
 
+        [[nodiscard]] virtual size_t get_membership_queries_n() const;
+
         virtual std::optional<std::string>
         equivalence_query(one_counter_automaton &automaton, const std::string &path) = 0;
     };
@@ -32,6 +37,8 @@ namespace active_learning {
     public:
         [[nodiscard]] std::string sum_up_msg() const override;
 
+        [[nodiscard]] size_t get_membership_queries_n() const override;
+
         bool membership_query(const std::string &word) override;
 
     private:
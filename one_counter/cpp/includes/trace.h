@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace active_learning {
+
+    enum class trace_output {
+        chrome_json,    // Every span is kept, and written as Chrome trace-event JSON when the trace stops
+        ring_buffer     // Only the last spans are kept, in a fixed-size buffer
+    };
+
+    // A closed span of a trace. Names and keys are not copied, they must be string literals.
+    struct trace_event {
+        static constexpr size_t max_args = 6;
+
+        const char *name;
+        uint64_t start_ns;
+        uint64_t duration_ns;
+        uint32_t thread;
+        uint32_t args_n;
+        std::array<std::pair<const char *, int64_t>, max_args> args;
+    };
+
+    /**
+     * Recorder of the spans of a learning run, to find out which phases it spends its time in.
+     * Spans are only recorded between start() and stop(), and only in builds where V1C2AL_TRACE is defined,
+     * the macros at the end of this file compiling to nothing otherwise.
+     */
+    class tracer {
+    public:
+        static tracer &get_default();
+
+        void start(trace_output output, const std::string &path, size_t ring_capacity = 1 << 16);
+
+        void stop();
+
+        [[nodiscard]] bool is_active() const;
+
+        [[nodiscard]] uint64_t now_ns() const;
+
+        void record(const trace_event &event);
+
+        [[nodiscard]] std::vector<trace_event> get_events() const;
+
+        void write_chrome_json(const std::string &path) const;
+
+    private:
+        mutable std::mutex mutex_;
+        std::atomic<bool> active_ = false;
+        std::string path_;
+        uint64_t origin_ns_ = 0;
+        // Events in recording order, or the ring buffer whose oldest event is at ring_next_ once it is full
+        std::vector<trace_event> events_;
+        size_t ring_capacity_ = 0;
+        size_t ring_next_ = 0;
+    };
+
+    /**
+     * Span of a trace, covering the lifetime of the object, on the thread that created it.
+     * Annotations go to the innermost open span of their thread.
+     */
+    class trace_span {
+    public:
+        explicit trace_span(const char *name);
+
+        trace_span(const trace_span &) = delete;
+
+        trace_span &operator=(const trace_span &) = delete;
+
+        ~trace_span();
+
+        static void annotate(const char *key, int64_t value);
+
+    private:
+        trace_event event_{};
+        trace_span *parent_ = nullptr;
+        bool active_ = false;
+    };
+}
+
+#define V1C2AL_TRACE_CONCAT_(a, b) a##b
+#define V1C2AL_TRACE_CONCAT(a, b) V1C2AL_TRACE_CONCAT_(a, b)
+
+#ifdef V1C2AL_TRACE
+#define V1C2AL_TRACE_SPAN_(name) ::active_learning::trace_span V1C2AL_TRACE_CONCAT(trace_span_, __LINE__)(name);
+#define V1C2AL_TRACE_ARG(key, value) ::active_learning::trace_span::annotate(key, static_cast<int64_t>(value))
+#else
+#define V1C2AL_TRACE_SPAN_(name)
+#define V1C2AL_TRACE_ARG(key, value) ((void) 0)
+#endif
+
+// Spans are also the phases allocations are counted in (see allocation_tracker.h)
+#ifdef V1C2AL_ALLOC_TRACKING
+#include "allocation_tracker.h"
+#define V1C2AL_ALLOC_SCOPE_(name) \
+    ::active_learning::allocation_scope V1C2AL_TRACE_CONCAT(allocation_scope_, __LINE__)(name);
+#else
+#define V1C2AL_ALLOC_SCOPE_(name)
+#endif
+
+#define V1C2AL_TRACE_SPAN(name) V1C2AL_TRACE_SPAN_(name) V1C2AL_ALLOC_SCOPE_(name) ((void) 0)
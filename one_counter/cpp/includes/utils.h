@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 namespace utils {
 
     // Used for pair inside set
@@ -55,4 +57,19 @@ namespace utils {
     inline triple_comp<T1, T2, T3> make_triple_comp(T1 e1, T2 e2, T3 e3) {
         return triple_comp(e1, e2, e3);
     }
+
+    /**
+     * Label of a counter guard [lo, hi] in DOT files: "c" for a single value, "lo-hi" for a range,
+     * "lo+" when it covers every value from lo (hi reaching the max level), "*" for every value
+     */
+    inline std::string guard_label(size_t lo, size_t hi, size_t max_level) {
+        if (hi >= max_level and lo == 0)
+            return "*";
+        if (hi >= max_level)
+            return std::to_string(lo) + "+";
+        if (lo == hi)
+            return std::to_string(lo);
+
+        return std::to_string(lo) + "-" + std::to_string(hi);
+    }
 }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "V1CA.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace active_learning {
+
+    /**
+     * Read-only view of a V1CA as a behaviour graph, computed on demand over the storage of the V1CA.
+     * Vertices are the states of the V1CA, a vertex of level l being reached with a counter value of l. Edges are
+     * the transitions taken on that counter value, except the ones leaving the max level upward (loop-ins).
+     * Nothing is copied, so the V1CA must outlive the view.
+     */
+    class v1ca_behaviour_view {
+    public:
+        using state_t = V1CA::state_t;
+        using states_t = std::vector<state_t>;
+
+        explicit v1ca_behaviour_view(const V1CA &automaton);
+
+        [[nodiscard]] size_t states_n() const;
+
+        // Same as states_n(), vertices being the states
+        [[nodiscard]] size_t vertices_n() const;
+
+        [[nodiscard]] size_t max_level() const;
+
+        [[nodiscard]] state_t init_state() const;
+
+        [[nodiscard]] size_t level(state_t state) const;
+
+        [[nodiscard]] const std::string &name(state_t state) const;
+
+        // Vertices are identified by their state
+        [[nodiscard]] size_t id(state_t state) const;
+
+        [[nodiscard]] bool is_final(state_t state) const;
+
+        [[nodiscard]] bool is_init(state_t state) const;
+
+        [[nodiscard]] int effect(char symbol) const;
+
+        [[nodiscard]] std::optional<state_t> get_next_vertex(state_t from, char symbol) const;
+
+        [[nodiscard]] std::optional<state_t> get_prev_vertex(state_t to, char symbol) const;
+
+        [[nodiscard]] states_t get_prev_vertices(state_t to, char symbol) const;
+
+        [[nodiscard]] states_t get_all_states_of_level(size_t level) const;
+
+        // Transition of the V1CA itself, for any counter value
+        [[nodiscard]] std::optional<state_t> step(state_t from, char symbol, size_t cv) const;
+
+        [[nodiscard]] const V1CA &base() const;
+
+    private:
+        const V1CA &automaton_;
+    };
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace active_learning {
+
+    enum class visualization_mode {
+        disabled,       // display() does nothing
+        dot_only,       // display() writes the .dot file, without rendering it
+        async_png       // display() writes the .dot file, then renders it as a .png
+    };
+
+    /**
+     * Destination of the graphs exported by display(), so that the learning loop does not wait for files to be
+     * written or for Graphviz to render them. Graphs are handed over as DOT text, and written then rendered by
+     * a single background worker, in the order they were submitted.
+     * Graphs waiting for the worker are coalesced by path: submitting a graph to a path that is already waiting
+     * replaces the older graph, so only the newest graph of a path is rendered.
+     */
+    class visualization_sink {
+    public:
+        explicit visualization_sink(visualization_mode mode = visualization_mode::async_png);
+
+        visualization_sink(const visualization_sink &) = delete;
+
+        visualization_sink &operator=(const visualization_sink &) = delete;
+
+        ~visualization_sink();
+
+        // Sink used by every display(), flushed when the program exits
+        static visualization_sink &get_default();
+
+        void set_mode(visualization_mode mode);
+
+        [[nodiscard]] visualization_mode get_mode() const;
+
+        // Whether submitted graphs are used at all, so that callers can skip building them
+        [[nodiscard]] bool is_enabled() const;
+
+        void submit(const std::string &path, std::string dot);
+
+        void flush();
+
+        // Number of graphs written, and of graphs replaced by a newer one before being written
+        [[nodiscard]] size_t written() const;
+
+        [[nodiscard]] size_t coalesced() const;
+
+    private:
+        struct job_t {
+            std::string dot;
+            visualization_mode mode;
+        };
+
+        void run();
+
+        static void write(const std::string &path, const job_t &job);
+
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable idle_;
+        visualization_mode mode_;
+        // Graphs waiting for the worker by path, and their paths in submission order
+        std::map<std::string, job_t> pending_;
+        std::deque<std::string> queue_;
+        bool busy_ = false;
+        bool stop_ = false;
+        size_t written_ = 0;
+        size_t coalesced_ = 0;
+        // Only started by the first submitted graph
+        std::thread worker_;
+    };
+}
@@ -1,10 +1,21 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace active_learning {
     class word_counter {
     public:
         virtual int get_cv(const std::string &word) const = 0;
+
+        // Counter value of every prefix of word, from "" (index 0) to word itself (index word.size())
+        virtual std::vector<int> get_prefixes_cv(const std::string &word) const {
+            auto res = std::vector<int>();
+            res.reserve(word.size() + 1);
+            for (auto len = 0u; len <= word.size(); ++len)
+                res.emplace_back(get_cv(word.substr(0, len)));
+
+            return res;
+        }
     };
-}
\ No newline at end of file
+}
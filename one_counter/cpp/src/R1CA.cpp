@@ -1,6 +1,8 @@
 #include "R1CA.h"
 
-#include <fstream>
+#include "dot_writers.h"
+#include "visualization_sink.h"
+
 #include <utility>
 
 namespace active_learning {
@@ -13,14 +15,14 @@ namespace active_learning {
         // Getting from states to states using symbol of the word
         for (char c : word) {
             // FIXME max_lvl_ or max_level_ + 1 (and underneath as well)
-            auto counter_clip = (static_cast<size_t>(counter) > max_level_) ? max_level_ : counter;
+            auto counter_clip = std::min(static_cast<size_t>(counter), max_level_);
 
-            if (not transitions_.contains({curr_state, counter_clip, c}))
+            const auto *trans_y = transitions_.find(curr_state, c, counter_clip);
+            if (not trans_y)
                 return false;
 
-            transition_y trans_y = transitions_.at({curr_state, counter_clip, c});
-            curr_state = trans_y.state;
-            counter += trans_y.effect;
+            curr_state = trans_y->state;
+            counter += trans_y->effect;
 
             if (counter < 0)
                 return false;
@@ -36,14 +38,14 @@ namespace active_learning {
 
         // Getting from states to states using symbol of the word
         for (char c : word) {
-            auto counter_clip = (static_cast<size_t>(counter) > max_level_) ? max_level_ : counter;
+            auto counter_clip = std::min(static_cast<size_t>(counter), max_level_);
 
-            if (not transitions_.contains({curr_state, counter_clip, c}))
+            const auto *trans_y = transitions_.find(curr_state, c, counter_clip);
+            if (not trans_y)
                 return -1;
 
-            transition_y trans_y = transitions_.at({curr_state, counter_clip, c});
-            curr_state = trans_y.state;
-            counter += trans_y.effect;
+            curr_state = trans_y->state;
+            counter += trans_y->effect;
 
             if (counter < 0)
                 return -1;
@@ -52,6 +54,41 @@ namespace active_learning {
         return counter;
     }
 
+    /**
+     * Run the R1CA once on a word and record the counter value after each of its prefixes, so that counting
+     * every prefix of a word costs a single simulation instead of one per prefix.
+     * @param word The word to be processed
+     * @return The counter value of every prefix of the word, from "" (index 0) to the word itself
+     * (index word.size()). As with count(), it is -1 for a prefix that has no run, and for all longer ones.
+     */
+    std::vector<int> R1CA::count_prefixes(const std::string &word) const {
+        auto res = std::vector<int>(word.size() + 1, -1);
+        auto curr_state = init_state_;
+        int counter = 0;
+        res[0] = counter;
+
+        for (auto i = 0u; i < word.size(); ++i) {
+            auto counter_clip = std::min(static_cast<size_t>(counter), max_level_);
+
+            const auto *trans_y = transitions_.find(curr_state, word[i], counter_clip);
+            if (not trans_y)
+                break;
+
+            curr_state = trans_y->state;
+            counter += trans_y->effect;
+
+            if (counter < 0)
+                break;
+            res[i + 1] = counter;
+        }
+
+        return res;
+    }
+
+    bool R1CA::transition_y::operator==(const transition_y &other) const {
+        return state == other.state and effect == other.effect;
+    }
+
     const basic_alphabet &R1CA::get_alphabet() const {
         return alphabet_;
     }
@@ -96,47 +133,31 @@ namespace active_learning {
                 const auto inf = color.first;
                 const auto level = color.second;
 
-                if (inf) {
-                    for (auto i = 0u; i <= level; ++i)
-                        transitions_[{src, i, symbol}] = {dest, effect};
-                } else {
-                    for (auto i = level - 1; i > level; --i)
-                        transitions_[{src, i, symbol}] = {dest, effect};
-                }
+                // Taken up to the level, or above it
+                if (inf)
+                    transitions_.assign(src, symbol, 0, level, {dest, effect});
+                else
+                    transitions_.assign(src, symbol, level + 1, transition_func_t::unbounded, {dest, effect});
             } else {
                 // Non-conditional transition
-                for (auto i = 0u; i < max_level; ++i)
-                    transitions_[{src, i, symbol}] = {dest, effect};
+                transitions_.assign(src, symbol, 0, transition_func_t::unbounded, {dest, effect});
             }
         }
     }
 
+    /**
+     * Export the R1CA as a .dot file, and a .png file depending on the mode of the visualization sink.
+     * Files are written in the background.
+     * @param path The path to the R1CA png and dot file, without the extension
+     */
     void R1CA::display(const std::string &path) {
-        // Writing dot file
-        std::string full_path = path + ".dot";
-        std::ofstream file;
-        file.open(full_path);
-
-        // Writing states
-        file << "digraph G {\n";
-        for (auto i = 0u; i < states_n_; ++i) {
-            file << i << "[ shape=\""
-                 << ((is_final(i)) ? "doublecircle" : "circle")
-                 << "\"];\n";
-        }
-        for (auto &trans : transitions_) {
-            file << trans.first.state
-                 << "->"
-                 << trans.second.state
-                 << " [label=\""
-                 << trans.first.symbol
-                 << "\"];\n";
-        }
-        file.close();
+        auto &sink = visualization_sink::get_default();
+        if (!sink.is_enabled())
+            return;
 
-        // Creating png file
-        // Hoping that you are on linux and have dot installed
-        system(("dot -Tpng " + full_path + " > " + path + ".png").c_str());
+        auto out = dot_buffer();
+        writer::write_r1ca(out, *this);
+        sink.submit(path, out.release());
     }
 
     R1CA R1CA::from_scratch(size_t init_state, size_t states_n, size_t max_lvl,
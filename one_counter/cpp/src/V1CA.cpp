@@ -1,47 +1,45 @@
 #include <queue>
-#include <fstream>
 #include <utility>
 #include <boost/graph/graphviz.hpp>
 #include <boost/graph/adjacency_list.hpp>
 
 #include "V1CA.h"
+#include "lifted_v1ca.h"
 #include "dot_writers.h"
+#include "visualization_sink.h"
+#include "trace.h"
 
 namespace active_learning {
 
     /**
-     * Export the V1CA as a png and .dot file.
-     * This function requires to be on linux and have dot installed to get the .png file
+     * Export the V1CA as a .dot file, and a .png file depending on the mode of the visualization sink.
+     * Files are written in the background, the .png requiring to be on linux and have dot installed.
      * @param path The path to the V1CA png and dot file, without the extension
      */
     void V1CA::display(const std::string &path) {
+        auto &sink = visualization_sink::get_default();
+        if (!sink.is_enabled())
+            return;
 
-        // Writing dot file
-        std::string full_path = path + ".dot";
-        std::ofstream file;
-        file.open(full_path);
-        writer::write_v1ca(file, *this);
-        file.close();
-
-        // Creating png file
-        // Hoping that you are on linux and have dot installed
-        system(("dot -Tpng " + full_path + " > " + path + ".png").c_str());
+        auto out = dot_buffer();
+        writer::write_v1ca(out, *this);
+        sink.submit(path, out.release());
     }
 
     /**
      * Tell whether is two V1CA are equivalent, i.e if their language are the same.
      * @param other The other V1CA.
-     * @return true if they are equivalent, false otherwise.
+     * @param engine The algorithm used to check equivalence. The product engine finds a shortest counter-example.
+     * @return std::nullopt if they are equivalent,
+     *  a counter-example word accepted by one V1CA but not by the other otherwise.
      */
-    std::optional<std::string> V1CA::is_equivalent_to(V1CA &other) const {
-        auto res_left = is_subset_of(other);
-        if (res_left)
-            return res_left;
-        auto res_right = other.is_subset_of(*this);
-        if (res_right)
-            return res_right;
+    std::optional<std::string> V1CA::is_equivalent_to(V1CA &other, equivalence_engine engine) const {
+        V1C2AL_TRACE_SPAN("V1CA::is_equivalent_to");
+        V1C2AL_TRACE_ARG("states", states_n_ + other.states_n_);
+        if (engine == equivalence_engine::union_find)
+            return find_difference_union_find_(*this, other);
 
-        return std::nullopt;
+        return find_difference_(*this, other, true);
     }
 
     /**
@@ -51,126 +49,342 @@ namespace active_learning {
      *  a counter-example string of a word contained in this V1CA but not in the other otherwise.
      */
     std::optional<std::string> V1CA::is_subset_of(const V1CA &other) const {
-        auto other_complement = other.complement();
-        return inter_with(other_complement).empty();
+        return find_difference_(*this, other, false);
     }
 
     /**
-     * Recursive function for empty()
+     * Explore the synchronized product of two V1CA on the fly, one (state1, state2, counter value) configuration
+     * at a time, without building any automaton. A missing transition leads to a rejecting sink state.
+     * The exploration is breadth-first and stops at the first configuration where the V1CA disagree.
+     * @param left The first V1CA
+     * @param right The second V1CA
+     * @param symmetric false to only look for words accepted by left and not by right (inclusion),
+     * true to also look for words accepted by right and not by left (equivalence)
+     * @return std::nullopt if no difference was found, a shortest word on which the V1CA disagree otherwise.
      */
-    std::optional<std::string> V1CA::empty_(std::set<state_t> &visited, state_t curr, std::string curr_word) const {
-
-        if (visited.contains(curr))
-            return std::nullopt;
+    std::optional<std::string> V1CA::find_difference_(const V1CA &left, const V1CA &right, bool symmetric) {
+        if (not (left.alphabet_ == right.alphabet_))
+            throw std::invalid_argument("Comparison of two V1CA must be performed on V1CA with the same dictionaries.");
+
+        const auto left_sink = left.states_n_;
+        const auto right_sink = right.states_n_;
+        // Pairs of states (sinks included) are packed as left * (right_sink + 1) + right
+        const auto pairs_n = static_cast<uint64_t>(left_sink + 1) * (right_sink + 1);
+        const auto bound = difference_bound_(left, right);
+        const auto config_of = [pairs_n, right_sink](state_t st1, state_t st2, size_t cv) {
+            return cv * pairs_n + st1 * (right_sink + 1) + st2;
+        };
+
+        auto parents = config_map<config_parent_t>(left.states_n_ * right.states_n_);
+        auto queue = std::queue<std::tuple<state_t, state_t, size_t>>();
+        const auto init_config = config_of(left.init_state_, right.init_state_, 0);
+        parents.insert(init_config, {init_config, 0});
+        queue.emplace(left.init_state_, right.init_state_, 0);
+
+        while (not queue.empty()) {
+            auto [st1, st2, cv] = queue.front();
+            queue.pop();
+
+            if (cv == 0) {
+                auto final1 = left.final_states_.contains(st1);
+                auto final2 = right.final_states_.contains(st2);
+                if ((final1 and not final2) or (symmetric and final2 and not final1))
+                    return rebuild_witness(parents, config_of(st1, st2, cv), init_config);
+            }
 
-        visited.insert(curr);
+            for (auto symbol : left.alphabet_.symbols()) {
+                auto symbol_cv = left.alphabet_.get_cv(symbol);
+                if (symbol_cv < 0 and cv < static_cast<size_t>(-symbol_cv))
+                    continue;
+                auto next_cv = cv + symbol_cv;
+                if (next_cv > bound)
+                    continue;
 
-        if (final_states_.contains(curr))
-            return curr_word;
+                auto trans1 = (st1 == left_sink) ? nullptr : left.step(st1, cv, symbol);
+                auto trans2 = (st2 == right_sink) ? nullptr : right.step(st2, cv, symbol);
+                // Nothing can be accepted anymore on the side(s) we look for a difference from
+                if (not trans1 and (not symmetric or not trans2))
+                    continue;
 
-        for (const auto &out_trans : get_out_trans(curr)) {
-            auto out_state = out_trans.second.state;
-            auto empty = empty_(visited, out_state, curr_word + out_trans.first.symbol);
-            if (empty)
-                return empty;
+                auto next1 = trans1 ? trans1->state : left_sink;
+                auto next2 = trans2 ? trans2->state : right_sink;
+                if (parents.insert(config_of(next1, next2, next_cv), {config_of(st1, st2, cv), symbol}))
+                    queue.emplace(next1, next2, next_cv);
+            }
         }
 
         return std::nullopt;
     }
 
     /**
-     * Tell whether the language of a V1CA is empty, i.e if the V1CA cannot accept any word.
-     * @return std::nullopt if the language is empty,
-     *         a string containing an supposedly accepted word if the language is not empty.
+     * Decide the equivalence of two deterministic V1CA with the Hopcroft-Karp algorithm: configurations of both
+     * V1CA are merged in a union-find structure as soon as they are assumed equivalent, so every configuration
+     * is expanded at most once instead of every pair of configurations.
+     * A missing transition leads to a rejecting sink, shared by all counter values.
+     * Pairs are processed breadth-first, which keeps counter-examples short.
+     * @param left The first V1CA
+     * @param right The second V1CA
+     * @return std::nullopt if they are equivalent, a word accepted by only one of them otherwise.
      */
-    std::optional<std::string> V1CA::empty() const {
-        // Doing a recursive traversal and checking whether there is an accessible final state
-        std::set<state_t> visited;
-        // There need to be only one starting state though
-        return empty_(visited, init_state_, "");
+    std::optional<std::string> V1CA::find_difference_union_find_(const V1CA &left, const V1CA &right) {
+        if (not (left.alphabet_ == right.alphabet_))
+            throw std::invalid_argument("Comparison of two V1CA must be performed on V1CA with the same dictionaries.");
+
+        struct pair_t {
+            state_t st1;
+            state_t st2;
+            size_t cv;
+            size_t parent;
+            char symbol;
+        };
+
+        const auto left_sink = left.states_n_;
+        const auto right_sink = right.states_n_;
+        const auto bound = difference_bound_(left, right);
+
+        // Configurations of both V1CA get a node in the union-find, the lowest bit of the key tells the side
+        auto node_ids = config_map<size_t>(left.states_n_ + right.states_n_);
+        auto uf_parents = std::vector<size_t>();
+        auto uf_sizes = std::vector<size_t>();
+        const auto node_of = [&](bool is_right, state_t state, size_t cv) {
+            auto sink = is_right ? right_sink : left_sink;
+            auto key = ((state == sink ? 0 : cv) * (sink + 1) + state) * 2 + is_right;
+            if (node_ids.insert(key, uf_parents.size())) {
+                uf_parents.emplace_back(uf_parents.size());
+                uf_sizes.emplace_back(1);
+            }
+            return *node_ids.find(key);
+        };
+        const auto find = [&](size_t node) {
+            while (uf_parents[node] != node) {
+                uf_parents[node] = uf_parents[uf_parents[node]];
+                node = uf_parents[node];
+            }
+            return node;
+        };
+
+        // Pairs assumed equivalent and still to be checked, kept after processing to rebuild the counter-example
+        auto pairs = std::vector<pair_t>();
+        pairs.push_back({left.init_state_, right.init_state_, 0, 0, 0});
+        auto init1 = node_of(false, left.init_state_, 0);
+        auto init2 = node_of(true, right.init_state_, 0);
+        uf_parents[init2] = init1;
+        uf_sizes[init1] += uf_sizes[init2];
+
+        for (auto pair_i = 0ul; pair_i < pairs.size(); ++pair_i) {
+            auto [st1, st2, cv, parent, symbol] = pairs[pair_i];
+
+            auto accept1 = cv == 0 and st1 != left_sink and left.final_states_.contains(st1);
+            auto accept2 = cv == 0 and st2 != right_sink and right.final_states_.contains(st2);
+            if (accept1 != accept2) {
+                auto witness = std::string();
+                for (auto i = pair_i; i != 0; i = pairs[i].parent)
+                    witness.push_back(pairs[i].symbol);
+
+                return std::string(witness.rbegin(), witness.rend());
+            }
+
+            for (auto next_symbol : left.alphabet_.symbols()) {
+                auto symbol_cv = left.alphabet_.get_cv(next_symbol);
+                if (symbol_cv < 0 and cv < static_cast<size_t>(-symbol_cv))
+                    continue;
+                auto next_cv = cv + symbol_cv;
+                if (next_cv > bound)
+                    continue;
+
+                auto trans1 = (st1 == left_sink) ? nullptr : left.step(st1, cv, next_symbol);
+                auto trans2 = (st2 == right_sink) ? nullptr : right.step(st2, cv, next_symbol);
+                if (not trans1 and not trans2)
+                    continue;
+
+                auto next1 = trans1 ? trans1->state : left_sink;
+                auto next2 = trans2 ? trans2->state : right_sink;
+                auto root1 = find(node_of(false, next1, next_cv));
+                auto root2 = find(node_of(true, next2, next_cv));
+                if (root1 == root2)
+                    continue;
+
+                // Union by size
+                if (uf_sizes[root1] < uf_sizes[root2])
+                    std::swap(root1, root2);
+                uf_parents[root2] = root1;
+                uf_sizes[root1] += uf_sizes[root2];
+
+                pairs.push_back({next1, next2, next_cv, pair_i, next_symbol});
+            }
+        }
+
+        return std::nullopt;
     }
 
     /**
-     * Recursive function for inter_with()
+     * Highest counter value a search for a shortest difference between two V1CA has to reach.
+     * Above the highest max level M, both V1CA behave the same at every counter value. If a shortest difference
+     * climbed more than k^2 levels above M, k being the number of pairs of states seen at counter values of M or
+     * more, two of these levels would be crossed up and then down with the same two pairs of states, and the parts
+     * of the word in between could be cut. The bound has to be quadratic: a^n b^n with n a multiple of both p and q,
+     * checked by p states going up and q going down, first differs from the empty language at n = pq.
+     * The pairs are gathered on the product with every counter value above M merged, which may only add pairs.
+     * @param left The first V1CA
+     * @param right The second V1CA
+     * @return M + k^2
      */
-    void V1CA::inter_with_(const V1CA &automaton1, const V1CA &automaton2,
-                     std::set<V1CA::state_t> &visited1,
-                     std::set<V1CA::state_t> &visited2,
-                     std::map<V1CA::state_t, V1CA::state_t> &auto1_state_to_res_state,
-                     V1CA::state_t curr1, V1CA::state_t curr2,
-                     V1CA &res, V1CA::state_t res_curr) {
-
-        if (visited1.contains(curr1) or visited2.contains(curr2))
-            return;
+    uint64_t V1CA::difference_bound_(const V1CA &left, const V1CA &right) {
+        const auto left_sink = left.states_n_;
+        const auto right_sink = right.states_n_;
+        const auto pairs_n = static_cast<uint64_t>(left_sink + 1) * (right_sink + 1);
+        const auto max_level = std::max(left.max_level_, right.max_level_);
+        // Counter values 0 to M, and M + 1 standing for all the ones above
+        const auto config_of = [pairs_n, right_sink](state_t st1, state_t st2, size_t cv) {
+            return cv * pairs_n + st1 * (right_sink + 1) + st2;
+        };
+
+        auto seen = std::vector<bool>(pairs_n * (max_level + 2));
+        auto top_pairs = std::vector<bool>(pairs_n);
+        auto top_pairs_n = 0ul;
+        auto stack = std::vector<std::tuple<state_t, state_t, size_t>>{{left.init_state_, right.init_state_, 0}};
+        seen[config_of(left.init_state_, right.init_state_, 0)] = true;
 
-        visited1.insert(curr1);
-        visited2.insert(curr2);
+        while (not stack.empty()) {
+            auto [st1, st2, cv] = stack.back();
+            stack.pop_back();
 
-        auto handled_dest = std::set<state_t>();
-        for (auto out_trans1 : automaton1.get_out_trans(curr1)) {
+            if (cv >= max_level and not top_pairs[config_of(st1, st2, 0)]) {
+                top_pairs[config_of(st1, st2, 0)] = true;
+                ++top_pairs_n;
+            }
 
-            // Picking a state to add or not
-            auto dest_to_handle = out_trans1.second.state;
-            if (handled_dest.contains(dest_to_handle))
-                continue;
-            handled_dest.insert(dest_to_handle);
+            for (auto symbol : left.alphabet_.symbols()) {
+                auto symbol_cv = left.alphabet_.get_cv(symbol);
+                if (symbol_cv < 0 and cv < static_cast<size_t>(-symbol_cv))
+                    continue;
 
-            // Getting all transitions from current state to dest state
-            auto transitions_to_dest = std::set<transition_x>();
-            for (auto out_trans_1_other : automaton1.get_out_trans(curr1)) {
-                if (out_trans1.second.state == dest_to_handle)
-                    transitions_to_dest.insert(out_trans_1_other.first);
-            }
+                auto trans1 = (st1 == left_sink) ? nullptr : left.step(st1, cv, symbol);
+                auto trans2 = (st2 == right_sink) ? nullptr : right.step(st2, cv, symbol);
+                if (not trans1 and not trans2)
+                    continue;
 
-            // Checking if transitions exist in automaton2
-            auto transitions2_to_dest = std::set<transition_x>();
-            for (auto &trans1 : transitions_to_dest) {
-                for (auto out_trans_2 : automaton2.get_out_trans(curr2)) {
-                    if (trans1.symbol == out_trans_2.first.symbol and trans1.counter == out_trans_2.first.counter)
-                        transitions2_to_dest.insert(out_trans_2.first);
+                auto next1 = trans1 ? trans1->state : left_sink;
+                auto next2 = trans2 ? trans2->state : right_sink;
+                // Going down from above M may land on M or stay above it
+                auto next_cvs = std::vector<size_t>{std::min(cv + symbol_cv, max_level + 1)};
+                if (cv == max_level + 1 and symbol_cv < 0)
+                    next_cvs.push_back(cv);
+                for (auto next_cv : next_cvs) {
+                    if (not seen[config_of(next1, next2, next_cv)]) {
+                        seen[config_of(next1, next2, next_cv)] = true;
+                        stack.emplace_back(next1, next2, next_cv);
+                    }
                 }
             }
+        }
 
-            // We check that there is the same number of equal transitions
-            // We also check that all transition from trans2 go to same destination
-            // (we could optimize by saying that if 2 states are not the same, both can't be added to res)
-            auto common_dest = transitions2_to_dest.size() == transitions_to_dest.size();
-            auto dest2 = automaton2.transitions_.at(*transitions2_to_dest.begin()).state;
-            for (auto any_dest_2 : transitions2_to_dest)
-                common_dest &= automaton2.transitions_.at(any_dest_2).state == dest2;
+        return max_level + top_pairs_n * top_pairs_n;
+    }
 
-            // Checking that both were never visited
-            common_dest &= (visited1.contains(dest_to_handle) == visited2.contains(dest2));
+    /**
+     * Rebuild the word leading to a configuration by following its parents back to the initial configuration
+     */
+    std::string V1CA::rebuild_witness(const config_map<config_parent_t> &parents, uint64_t config,
+                                      uint64_t init_config) {
+        auto witness = std::string();
+        while (config != init_config) {
+            auto parent = parents.find(config);
+            witness.push_back(parent->symbol);
+            config = parent->config;
+        }
 
-            // If the destination is not verified by automaton2, we stop trying
-            if (not common_dest)
-                break;
+        return {witness.rbegin(), witness.rend()};
+    }
 
-            // Adding new state to result if state was never visited before
-            auto res_dest = 424242u;
-            if (not visited1.contains(dest_to_handle)) {
-                res_dest = res.add_state({automaton1.state_props_.at(curr1).level,
-                                            automaton1.state_props_.at(curr1).name + "~" +
-                                            automaton2.state_props_.at(curr2).name});
-                auto1_state_to_res_state.insert({dest_to_handle, res_dest});
-            } else {
-                res_dest = auto1_state_to_res_state.at(dest_to_handle);
-            }
+    /**
+     * Get the transition taken when reading a symbol from a configuration of the V1CA.
+     * Counter values above max_level_ use the transitions of max_level_.
+     * @param from The current state
+     * @param cv The current counter value
+     * @param symbol The symbol to be read
+     * @return The transition, or nullptr if there is none
+     */
+    const V1CA::transition_y *V1CA::step(state_t from, size_t cv, char symbol) const {
+        return transitions_.find(from, symbol, std::min(cv, max_level_));
+    }
 
-            // Adding all transitions from current state to this state
-            for (auto &transition : transitions_to_dest) {
-                auto edge_ok = res.add_transition({res_curr, transition.counter, transition.symbol}, {res_dest, automaton1.transitions_.at(transition).color});
-                if (not edge_ok)
-                    throw std::runtime_error("Could not add transition to result automaton while processing intersection.");
+    /**
+     * Highest counter value that needs to be explored to find a shortest witness.
+     * Above max_level_ transitions no longer depend on the counter. A shortest accepted word never climbs more
+     * than states_n_^2 levels above it, otherwise a couple of matching call and return states repeats and the part
+     * of the word in between can be cut.
+     */
+    size_t V1CA::config_bound() const {
+        return max_level_ + states_n_ * states_n_;
+    }
+
+    /**
+     * Tell whether the language of a V1CA is empty, i.e if the V1CA cannot accept any word.
+     * This is a breadth-first search over the (state, counter value) configurations, so the witness is a shortest
+     * accepted word.
+     * @return std::nullopt if the language is empty,
+     *         a shortest word accepted by the V1CA (ending in a final state with counter value 0) otherwise.
+     */
+    std::optional<std::string> V1CA::empty() const {
+        const auto bound = config_bound();
+        const auto config_of = [this](state_t state, size_t cv) { return cv * states_n_ + state; };
+
+        // Configurations are visited once, and remember where they were reached from
+        auto parents = config_map<config_parent_t>(states_n_);
+        auto queue = std::queue<std::pair<state_t, size_t>>();
+        const auto init_config = config_of(init_state_, 0);
+        parents.insert(init_config, {init_config, 0});
+        queue.emplace(init_state_, 0);
+
+        while (not queue.empty()) {
+            auto [state, cv] = queue.front();
+            queue.pop();
+
+            if (cv == 0 and final_states_.contains(state))
+                return rebuild_witness(parents, config_of(state, cv), init_config);
+
+            for (auto symbol : alphabet_.symbols()) {
+                auto symbol_cv = alphabet_.get_cv(symbol);
+                if (symbol_cv < 0 and cv < static_cast<size_t>(-symbol_cv))
+                    continue;
+                auto next_cv = cv + symbol_cv;
+                if (next_cv > bound)
+                    continue;
+
+                auto trans = step(state, cv, symbol);
+                if (not trans)
+                    continue;
+
+                if (parents.insert(config_of(trans->state, next_cv), {config_of(state, cv), symbol}))
+                    queue.emplace(trans->state, next_cv);
             }
+        }
 
-            auto dest1 = out_trans1.second.state;
-            inter_with_(automaton1, automaton2, visited1, visited2, auto1_state_to_res_state, dest1, dest2, res, res_dest);
+        return std::nullopt;
+    }
+
+    /**
+     * Get the guards of a (state, symbol) as they are used when running the V1CA: counter values above the max
+     * level use the transitions of the max level, so the guard containing it is extended to every higher value
+     */
+    std::vector<V1CA::guard_t> V1CA::effective_guards(const transition_func_t::guards_t &guards, size_t max_level) {
+        auto res = std::vector<guard_t>();
+        for (const auto &guard : guards) {
+            if (guard.lo > max_level)
+                break;
+            res.push_back({guard.lo, (guard.hi >= max_level) ? transition_func_t::unbounded : guard.hi,
+                           guard.target});
         }
+
+        return res;
     }
 
     /**
-     * Get the V1CA whose language is the intersection of the languages of two given V1CA
+     * Get the V1CA whose language is the intersection of the languages of two given V1CA.
+     * This is the synchronized product of the reachable pairs of states. Both V1CA are seen lifted to the same
+     * max level, so a product state has the level of both its states. As both V1CA read the same counter,
+     * the guards of a product transition are the intersections of the guards of both V1CA.
      * @param other The other V1CA
      * @return The intersection V1CA
      */
@@ -178,30 +392,55 @@ namespace active_learning {
         if (not (alphabet_ == other.alphabet_))
             throw std::invalid_argument("Intersection of two V1CA must be performed on V1CA with the same dictionaries.");
 
-        // Making copies because we might need to modify these
-        V1CA automaton1 = V1CA(*this);
-        V1CA automaton2 = V1CA(other);
-
-        // Making both automata the same level
-        if (automaton1.max_level_ < automaton2.max_level_) {
-             automaton1.increase_max_level(automaton2.max_level_ - automaton1.max_level_);
-        } else if (automaton2.max_level_ < automaton1.max_level_) {
-            automaton2.increase_max_level(automaton1.max_level_ - automaton2.max_level_);
-        }
-
-        std::set<state_t> visited1;
-        std::set<state_t> visited2;
-
-        auto init_state1 = automaton1.init_state_;
-        auto init_state2 = automaton2.init_state_;
+        const auto max_level = std::max(max_level_, other.max_level_);
+        const auto left = lifted_v1ca(*this, max_level);
+        const auto right = lifted_v1ca(other, max_level);
 
         auto res = V1CA(alphabet_);
-        auto init = res.add_state({0, automaton1.state_props_.at(init_state1).name});
+        res.max_level_ = max_level;
+
+        auto state_of = std::map<std::pair<state_t, state_t>, state_t>();
+        auto stack = std::stack<std::pair<state_t, state_t>>();
+        const auto get_state = [&](state_t st1, state_t st2) {
+            auto found = state_of.find({st1, st2});
+            if (found != state_of.end())
+                return found->second;
+
+            auto state = res.add_state({left.level(st1), left.name(st1) + "~" + right.name(st2)});
+            if (left.is_final(st1) and right.is_final(st2))
+                res.final_states_.insert(state);
+            state_of.insert({{st1, st2}, state});
+            stack.emplace(st1, st2);
+            return state;
+        };
+        res.init_state_ = get_state(left.init_state(), right.init_state());
 
-        auto auto1_st_to_res_st = std::map<state_t, state_t>();
-        auto1_st_to_res_st.insert({init_state1, 0});
+        while (not stack.empty()) {
+            auto [st1, st2] = stack.top();
+            stack.pop();
+            auto src = state_of.at({st1, st2});
+
+            for (auto symbol : alphabet_.symbols()) {
+                // Both lists are sorted, intersecting them as in a merge
+                auto guards1 = left.guards(st1, symbol);
+                auto guards2 = right.guards(st2, symbol);
+                auto i = 0u;
+                auto j = 0u;
+                while (i < guards1.size() and j < guards2.size()) {
+                    auto lo = std::max(guards1[i].lo, guards2[j].lo);
+                    auto hi = std::min(guards1[i].hi, guards2[j].hi);
+                    if (lo <= hi) {
+                        auto dst = get_state(guards1[i].target.state, guards2[j].target.state);
+                        res.transitions_.assign(src, symbol, lo, hi, {dst, guards1[i].target.color});
+                    }
 
-        inter_with_(automaton1, automaton2, visited1, visited2, auto1_st_to_res_st, init_state1, init_state2, res, init);
+                    if (guards1[i].hi < guards2[j].hi)
+                        ++i;
+                    else
+                        ++j;
+                }
+            }
+        }
 
         return res;
     }
@@ -229,7 +468,8 @@ namespace active_learning {
     }
 
 
-    V1CA::V1CA(const visibly_alphabet_t &alphabet) : one_counter_automaton(static_cast<class alphabet&>((active_learning::alphabet &) alphabet), displayable_type::V1CA) {}
+    V1CA::V1CA(const visibly_alphabet_t &alphabet) : one_counter_automaton(static_cast<class alphabet&>((active_learning::alphabet &) alphabet), displayable_type::V1CA),
+                                                     alphabet_(alphabet) {}
 
     V1CA::V1CA(std::vector<state_prop> &state_props, state_t initial_state, std::vector<state_t> &final_states,
                visibly_alphabet_t &alphabet, std::vector<std::tuple<state_t, state_t, char>> &edges) :
@@ -252,12 +492,8 @@ namespace active_learning {
 
         std::cout << "\nTransitioning:\n";
         for (auto &transition : edges) {
-            for (auto cv = 0u; cv <= max_level_; ++cv) {
-                auto trans_x = transition_x{std::get<0>(transition), cv, std::get<2>(transition)};
-                auto trans_y = transition_y{std::get<1>(transition), transition_color::init};
-
-                transitions_.insert({trans_x, trans_y});
-            }
+            transitions_.assign(std::get<0>(transition), std::get<2>(transition), 0, transition_func_t::unbounded,
+                                {std::get<1>(transition), transition_color::init});
         }
     }
 
@@ -273,18 +509,29 @@ namespace active_learning {
     }
 
     bool V1CA::add_transition(const transition_x &x, const transition_y &y) {
-        if (x.state >= states_n_ or y.state >= states_n_)
+        return add_transition(x.state, x.symbol, x.counter, x.counter, y);
+    }
+
+    /**
+     * Add a transition taken on every counter value of [lo, hi], replacing the former ones on these values
+     * @return false if one of the states does not exist
+     */
+    bool V1CA::add_transition(state_t from, char symbol, size_t lo, size_t hi, const transition_y &y) {
+        if (from >= states_n_ or y.state >= states_n_)
             return false;
 
-        transitions_.insert({x, y});
+        transitions_.assign(from, symbol, lo, hi, y);
         return true;
     }
 
-    std::vector<std::pair<V1CA::transition_x, V1CA::transition_y>> V1CA::get_out_trans(state_t from) const {
-        std::vector<std::pair<transition_x, transition_y>> res;
-        for (auto trans : transitions_) {
-            if (trans.first.state == from)
-                res.emplace_back(trans);
+    /**
+     * Get the outgoing transitions of a state, as (symbol, guard) couples
+     */
+    std::vector<std::pair<char, V1CA::guard_t>> V1CA::get_out_trans(state_t from) const {
+        std::vector<std::pair<char, guard_t>> res;
+        for (auto it = transitions_.lower_bound(from); it != transitions_.end() and it->first.first == from; ++it) {
+            for (const auto &guard : it->second)
+                res.emplace_back(it->first.second, guard);
         }
 
         return res;
@@ -294,40 +541,45 @@ namespace active_learning {
 
         // couple.first and couple.second necessarily have different levels
         for (const auto &couple: couples) {
-            for (auto &trans : transitions_) {
 
-                // Only considering max_value transitions
-                if (trans.first.counter < max_level_)
-                    continue;
+            // Only considering the transitions taken at max level
+            auto max_level_trans = std::vector<std::tuple<state_t, char, transition_y>>();
+            for (const auto &[key, guards] : transitions_) {
+                const auto *trans_y = transitions_.find(key.first, key.second, max_level_);
+                if (trans_y)
+                    max_level_trans.emplace_back(key.first, key.second, *trans_y);
+            }
 
+            for (const auto &[state, symbol, trans_y] : max_level_trans) {
                 // Linking loop_in_bottom and loop_out
-                if (trans.first.state == couple.second
-                    and alphabet_.get_cv(trans.first.symbol) == -1) {
-
-                    transition_x new_edge_x = {couple.first, trans.first.counter, trans.first.symbol};
-                    transition_y new_edge_y = {trans.second.state, transition_color::loop_in_bottom};
-                    // deleting the possible former transition with same transition_x before adding the new one,
-                    // as the former one does not make anymore sense with this specific cv
-                    if (transitions_.contains(new_edge_x))
-                        transitions_.erase(new_edge_x);
-                    transitions_.insert({new_edge_x, new_edge_y});
+                if (state == couple.second
+                    and alphabet_.get_cv(symbol) == -1) {
 
                     // Coloring of loop_out (is not mandatory)
-                    for (auto &other_trans : transitions_) {
-                        if (other_trans.first.state == new_edge_x.state
-                            and other_trans.first.symbol == new_edge_x.symbol
-                            and other_trans.first.counter < new_edge_x.counter) {
-                            transitions_[other_trans.first].color = transition_color::loop_out;
+                    const auto *former_guards = transitions_.guards(couple.first, symbol);
+                    auto below_max_level = std::vector<guard_t>();
+                    if (former_guards) {
+                        for (const auto &guard : *former_guards) {
+                            if (guard.lo < max_level_)
+                                below_max_level.push_back(guard);
                         }
                     }
-                // Linking loop in top
-                } else if (trans.first.state == couple.first
-                    and alphabet_.get_cv(trans.first.symbol) == 1) {
+                    for (const auto &guard : below_max_level) {
+                        transitions_.assign(couple.first, symbol, guard.lo, std::min(guard.hi, max_level_ - 1),
+                                            {guard.target.state, transition_color::loop_out});
+                    }
 
-                    transition_x new_edge_x = {couple.second, trans.first.counter, trans.first.symbol};
-                    transition_y new_edge_y = {trans.second.state, transition_color::loop_in_top};
+                    // The former transition at max level does not make sense anymore with this specific cv,
+                    // it is replaced
+                    transitions_.assign(couple.first, symbol, max_level_, transition_func_t::unbounded,
+                                        {trans_y.state, transition_color::loop_in_bottom});
+                // Linking loop in top
+                } else if (state == couple.first
+                    and alphabet_.get_cv(symbol) == 1
+                    and not transitions_.find(couple.second, symbol, max_level_)) {
 
-                    transitions_.insert({new_edge_x, new_edge_y});
+                    transitions_.assign(couple.second, symbol, max_level_, transition_func_t::unbounded,
+                                        {trans_y.state, transition_color::loop_in_top});
                 }
             }
         }
@@ -335,85 +587,235 @@ namespace active_learning {
 
     bool V1CA::accepts(const std::string &word) const {
         auto curr_state = init_state_;
-        auto cv = 0u;
+        auto cv = 0l;
 
         for (auto &c : word) {
-            auto trans_cv = (cv > max_level_) ? max_level_ : cv;
-            auto x = transition_x{curr_state, trans_cv, c};
-            if (not transitions_.contains(x))
+            auto trans = step(curr_state, static_cast<size_t>(cv), c);
+            if (not trans)
                 return false;
 
-            auto y = transitions_.at(x);
-            curr_state = y.state;
+            curr_state = trans->state;
             cv += alphabet_.get_cv(c);
+            // The counter cannot go below 0
+            if (cv < 0)
+                return false;
         }
 
         return final_states_.contains(curr_state) and not cv;
     }
 
-    void V1CA::increase_max_level(size_t n) {
-        auto new_max_level = max_level_ + n;
-        auto visited = std::set<state_t>();
-        auto stack = std::stack<state_t>();
-        stack.push(init_state_);
+    /**
+     * Get the states that can be reached from the initial state, regardless of the counter value
+     * @return The reachable states, sorted
+     */
+    std::vector<V1CA::state_t> V1CA::get_reachable_states() const {
+        auto successors = std::vector<std::vector<state_t>>(states_n_);
+        for (const auto &[key, guards] : transitions_) {
+            for (const auto &guard : guards)
+                successors[key.first].emplace_back(guard.target.state);
+        }
 
+        auto reached = std::vector<bool>(states_n_, false);
+        auto stack = std::vector<state_t>({init_state_});
+        reached[init_state_] = true;
         while (not stack.empty()) {
-            state_t curr_st = stack.top();
-            stack.pop();
+            auto state = stack.back();
+            stack.pop_back();
+            for (auto next : successors[state]) {
+                if (not reached[next]) {
+                    reached[next] = true;
+                    stack.emplace_back(next);
+                }
+            }
+        }
 
-            if (visited.contains(curr_st))
-                continue;
-            visited.insert(curr_st);
+        auto res = std::vector<state_t>();
+        for (state_t st = 0; st < states_n_; ++st) {
+            if (reached[st])
+                res.emplace_back(st);
+        }
 
-            auto out_trans = get_out_trans(curr_st);
+        return res;
+    }
 
-            for (auto trans: out_trans) {
-                (void) trans;
+    /**
+     * Get an equivalent V1CA with as few states as possible, using Hopcroft's partition refinement.
+     * Unreachable states are dropped. Two states can only be merged if they have the same level, the same
+     * finality, and transitions with the same colors for every (counter value, symbol), so the levels,
+     * loop colors and periodic links created by link_and_color_edges() are kept.
+     * The first state of each class is used as its representative (name and level).
+     * @return The minimized V1CA
+     */
+    V1CA V1CA::minimize() const {
+        V1C2AL_TRACE_SPAN("V1CA::minimize");
+        V1C2AL_TRACE_ARG("states", states_n_);
+        const auto states = get_reachable_states();
+        const auto n = states.size();
+        const auto sink = n;     // Missing transitions go to a sink, so the automaton is complete
+
+        auto index_of = std::vector<size_t>(states_n_, sink);
+        for (auto i = 0u; i < n; ++i)
+            index_of[states[i]] = i;
+
+        // Letters are (symbol, counter values) pieces on which no guard changes, each one starting at a guard bound
+        auto bounds = std::map<char, std::set<size_t>>();
+        for (const auto &[key, guards] : transitions_) {
+            for (const auto &guard : guards) {
+                if (guard.lo <= max_level_)
+                    bounds[key.second].insert(guard.lo);
+                if (guard.hi < max_level_)
+                    bounds[key.second].insert(guard.hi + 1);
             }
         }
+        auto letters = std::vector<std::pair<char, size_t>>();
+        for (const auto &[symbol, starts] : bounds) {
+            for (auto start : starts)
+                letters.emplace_back(symbol, start);
+        }
+        const auto letters_n = letters.size();
+
+        // Successor (and color) of every state on every letter, then predecessors for the splits
+        auto succ = std::vector<size_t>((n + 1) * letters_n, sink);
+        auto colors = std::vector<int>((n + 1) * letters_n, -1);
+        for (auto st = 0u; st < n; ++st) {
+            for (auto letter = 0u; letter < letters_n; ++letter) {
+                const auto *trans = step(states[st], letters[letter].second, letters[letter].first);
+                if (trans) {
+                    succ[st * letters_n + letter] = index_of[trans->state];
+                    colors[st * letters_n + letter] = static_cast<int>(trans->color);
+                }
+            }
+        }
+        auto pred = std::vector<std::vector<std::vector<size_t>>>(letters_n, std::vector<std::vector<size_t>>(n + 1));
+        for (auto st = 0u; st <= n; ++st) {
+            for (auto letter = 0u; letter < letters_n; ++letter)
+                pred[letter][succ[st * letters_n + letter]].emplace_back(st);
+        }
 
-        max_level_ = new_max_level;
-    }
-
-    void V1CA::increase_max_level() {
+        // Initial partition: level, finality and transition colors
+        using signature_t = std::tuple<size_t, bool, std::vector<int>>;
+        auto initial_blocks = std::map<signature_t, size_t>();
+        auto block_of = std::vector<size_t>(n + 1);
+        auto blocks = std::vector<std::vector<size_t>>();
+        for (auto st = 0u; st <= n; ++st) {
+            auto signature = (st == sink)
+                             ? signature_t{SIZE_MAX, false, {}}
+                             : signature_t{state_props_.at(states[st]).level, final_states_.contains(states[st]),
+                                           {colors.begin() + st * letters_n, colors.begin() + (st + 1) * letters_n}};
+            auto found = initial_blocks.insert({signature, blocks.size()});
+            if (found.second)
+                blocks.emplace_back();
+            block_of[st] = found.first->second;
+            blocks[block_of[st]].emplace_back(st);
+        }
 
-        auto dup_states = std::map<state_t, state_t>();
+        // Every (block, letter) splitter starts in the worklist
+        auto worklist = std::vector<std::pair<size_t, size_t>>();
+        auto in_worklist = std::vector<std::vector<bool>>(blocks.size(), std::vector<bool>(letters_n, true));
+        for (auto block = 0u; block < blocks.size(); ++block) {
+            for (auto letter = 0u; letter < letters_n; ++letter)
+                worklist.emplace_back(block, letter);
+        }
 
-        // Copying max_level states
-        for (state_t st = 0u; st < states_n_; ++st) {
-            auto prop = state_props_.at(st);
-            if (prop.level == max_level_) {
-                auto new_state = add_state({max_level_ + 1, prop.name + "_bis"});
-                dup_states.insert({st, new_state});
+        auto marked = std::vector<bool>(n + 1, false);
+        while (not worklist.empty()) {
+            auto [splitter, letter] = worklist.back();
+            worklist.pop_back();
+            in_worklist[splitter][letter] = false;
+
+            // States going into the splitter with letter, grouped by block
+            auto touched = std::vector<size_t>();
+            auto hits = std::map<size_t, std::vector<size_t>>();
+            for (auto target : blocks[splitter]) {
+                for (auto src : pred[letter][target]) {
+                    if (marked[src])
+                        continue;
+                    marked[src] = true;
+                    auto &block_hits = hits[block_of[src]];
+                    if (block_hits.empty())
+                        touched.emplace_back(block_of[src]);
+                    block_hits.emplace_back(src);
+                }
             }
-        }
 
-        // Handling transition
-        for (auto transition : transitions_) {
-            auto x = transition.first;
-            auto y = transition.second;
+            for (auto block : touched) {
+                auto &inside = hits[block];
+                auto outside = std::vector<size_t>();
+                for (auto st : blocks[block]) {
+                    if (not marked[st])
+                        outside.emplace_back(st);
+                }
+                for (auto st : inside)
+                    marked[st] = false;
+                if (outside.empty())
+                    continue;
 
-            // Copying edges at max_level to max_level + 1
-            if (state_props_.at(x.state).level == max_level_ and state_props_.at(y.state).level == max_level_) {
-                auto new_x = transition_x{dup_states.at(x.state), x.counter + 1, x.symbol};
-                auto new_y = transition_y{dup_states.at(y.state), y.color};
-                transitions_.insert({new_x, new_y});
+                // Splitting: states of inside move to a new block
+                auto new_block = blocks.size();
+                for (auto st : inside)
+                    block_of[st] = new_block;
+                blocks[block] = outside;
+                blocks.emplace_back(inside);
+                in_worklist.emplace_back(letters_n, false);
+
+                for (auto other_letter = 0u; other_letter < letters_n; ++other_letter) {
+                    // Both halves are needed if the block was still to be processed, otherwise the smaller is enough
+                    if (in_worklist[block][other_letter]
+                        or blocks[new_block].size() <= blocks[block].size()) {
+                        worklist.emplace_back(new_block, other_letter);
+                        in_worklist[new_block][other_letter] = true;
+                    } else {
+                        worklist.emplace_back(block, other_letter);
+                        in_worklist[block][other_letter] = true;
+                    }
+                }
             }
+        }
 
-            // Handling edges between max_level and max_level + 1
-            if (state_props_.at(x.state).level == max_level_) {
-                if (alphabet_.get_cv(x.symbol) == 1) {
-                    auto new_x = transition_x{x.state, x.counter, x.symbol};
-                    auto new_y = transition_y{dup_states.at(y.state), y.color};
-                    transitions_.insert({new_x, new_y});
-                } else if (alphabet_.get_cv(x.symbol) == -1) {
-                    auto new_x = transition_x{x.state, x.counter, x.symbol};
-                    auto new_y = transition_y{dup_states.at(y.state), y.color};
-                    transitions_.insert({new_x, new_y});
-                }
+        // Building the result, classes are numbered in the order of their first state so the initial state stays first.
+        // The sink has its own initial block, so it is never merged with an actual state.
+        auto res = V1CA(alphabet_);
+        res.max_level_ = max_level_;
+        auto class_of_block = std::map<size_t, state_t>();
+        for (auto st = 0u; st < n; ++st) {
+            auto block = block_of[st];
+            if (class_of_block.contains(block))
+                continue;
+            class_of_block[block] = res.add_state(state_props_.at(states[st]));
+            if (final_states_.contains(states[st]))
+                res.final_states_.insert(class_of_block[block]);
+        }
+        res.init_state_ = class_of_block.at(block_of[index_of[init_state_]]);
+
+        // Every state of a class behaves the same, the transitions of the representative are kept
+        auto done = std::set<size_t>();
+        for (auto st = 0u; st < n; ++st) {
+            if (not done.insert(block_of[st]).second)
+                continue;
+            for (const auto &[symbol, guard] : get_out_trans(states[st])) {
+                res.add_transition(class_of_block.at(block_of[st]), symbol, guard.lo, guard.hi,
+                                   {class_of_block.at(block_of[index_of[guard.target.state]]), guard.target.color});
             }
         }
 
-        ++max_level_;
+        return res;
+    }
+
+    /**
+     * Raise the max level of the V1CA by n, unrolling the states of the max level on the new levels.
+     * The language is unchanged. Only the reachable part of the lifted V1CA is kept.
+     * @param n The number of levels to be added
+     */
+    void V1CA::increase_max_level(size_t n) {
+        if (n == 0)
+            return;
+
+        auto lifted = lifted_v1ca(*this, max_level_ + n).to_v1ca();
+        init_state_ = lifted.init_state_;
+        states_n_ = lifted.states_n_;
+        max_level_ = lifted.max_level_;
+        final_states_ = std::move(lifted.final_states_);
+        transitions_ = std::move(lifted.transitions_);
+        state_props_ = std::move(lifted.state_props_);
     }
 }
@@ -1,137 +1,245 @@
-#include <fstream>
+#include <charconv>
 #include "V1CA_reader.h"
+#include "mapped_file.h"
 
 namespace active_learning {
 
-    static std::vector<std::string> get_all_lines(const std::string &path) {
+    v1ca_parse_error::v1ca_parse_error(const std::string &source, size_t line, size_t column,
+                                       const std::string &message)
+            : std::runtime_error(source + ":" + std::to_string(line) + ":" + std::to_string(column) + ": "
+                                 + message), line_(line), column_(column) {}
 
-        // Opening file
-        auto in_file = std::ifstream(path);
-        if (not in_file.is_open())
-            throw std::runtime_error("Could not open file '" + path + "'.");
-
-        // Recovering all lines (bad practice)
-        auto lines = std::vector<std::string>();
-        auto curr_line = std::string();
-
-        while (std::getline(in_file, curr_line)) {
-            lines.emplace_back(curr_line);
-        }
+    size_t v1ca_parse_error::line() const {
+        return line_;
+    }
 
-        in_file.close();
-        return lines;
+    size_t v1ca_parse_error::column() const {
+        return column_;
     }
 
-    static std::vector<std::pair<V1CA::transition_x, V1CA::transition_y>>
-    read_transition(const std::string &line) {
-        auto i = 0u;
-        while (i < line.size() and isdigit(line[i]))
-            ++i;
+    namespace {
 
-        auto from_str = line.substr(0, i);
+    /**
+     * Position in the text being parsed, moving forward one line at a time
+     */
+    class v1ca_cursor {
+    public:
+        v1ca_cursor(std::string_view text, const std::string &source)
+                : curr_(text.data()), end_(text.data() + text.size()), line_start_(curr_), source_(source) {}
 
-        if (i + 1 >= line.size()
-            or line[i] != '-'
-            or line[i + 1] != '>')
-            throw std::runtime_error("Could not parse transition: missing '->'. Line: " + line);
+        [[nodiscard]] bool at_end() const {
+            return curr_ == end_;
+        }
 
-        i += 2;
+        [[nodiscard]] bool at_line_end() const {
+            return curr_ == end_ or *curr_ == '\n' or *curr_ == '#'
+                   or (*curr_ == '\r' and (curr_ + 1 == end_ or curr_[1] == '\n'));
+        }
 
-        auto j = i;
-        while (i < line.size() and isdigit(line[i]))
-            ++i;
+        void skip_blanks() {
+            while (curr_ != end_ and (*curr_ == ' ' or *curr_ == '\t'))
+                ++curr_;
+        }
 
-        auto to_str = line.substr(j, i - j);
+        // Skipping blank and comment lines
+        void skip_empty_lines() {
+            while (true) {
+                skip_blanks();
+                if (at_end() or not at_line_end())
+                    return;
+                next_line();
+            }
+        }
 
-        if (i >= line.size() or line[i] != ' ')
-            throw std::runtime_error("Could not parse transition: missing space after x->x. Line: " + line);
-        ++i;
-        if (i >= line.size())
-            throw std::runtime_error("Could not parse transition: missing symbol. Line: " + line);
+        // Checking nothing but blanks or a comment is left on the line, and moving to the next one
+        void end_line() {
+            skip_blanks();
+            if (not at_line_end())
+                fail("unexpected '" + std::string(1, *curr_) + "', expected end of line");
+            next_line();
+        }
 
-        auto symbol = line[i];
+        void expect(std::string_view token) {
+            if (static_cast<size_t>(end_ - curr_) < token.size() or std::string_view(curr_, token.size()) != token)
+                fail("expected '" + std::string(token) + "'");
+            curr_ += token.size();
+        }
 
-        ++i;
-        if (i >= line.size())
-            throw std::runtime_error("Could not parse transition: missing space after symbol. Line: " + line);
-        ++i;
+        bool accept(std::string_view token) {
+            if (static_cast<size_t>(end_ - curr_) < token.size() or std::string_view(curr_, token.size()) != token)
+                return false;
+            curr_ += token.size();
+            return true;
+        }
 
-        j = i;
-        while (i < line.size() and isdigit(line[i]))
-            ++i;
+        size_t number(const char *what) {
+            size_t value = 0;
+            auto [ptr, ec] = std::from_chars(curr_, end_, value);
+            if (ec == std::errc::result_out_of_range)
+                fail(std::string(what) + " is too large");
+            if (ec != std::errc())
+                fail("expected " + std::string(what));
+            curr_ = ptr;
+            return value;
+        }
 
-        auto counter1_str = line.substr(j, i - j);
-        size_t from = 424242, to = 424242, counter1 = 424242;
-        try {
-            std::stringstream(from_str) >> from;
-            std::stringstream(to_str) >> to;
-            std::stringstream(counter1_str) >> counter1;
-        } catch (std::exception &e) {
-            throw std::runtime_error("Could not parse transition: Error while reading a number (probably empty number). Line: " + line);
+        // A sequence of non blank characters
+        std::string_view word() {
+            auto start = curr_;
+            while (curr_ != end_ and *curr_ != ' ' and *curr_ != '\t' and not at_line_end())
+                ++curr_;
+            return {start, static_cast<size_t>(curr_ - start)};
         }
 
-        auto res = std::vector<std::pair<V1CA::transition_x, V1CA::transition_y>>();
-        if (i >= line.size() or line[i] != '-') {
-            res.emplace_back(std::make_pair<V1CA::transition_x, V1CA::transition_y>({from, counter1, symbol}, {to, V1CA::transition_color::init}));
-            return res;
+        char symbol() {
+            if (at_line_end() or *curr_ == ' ' or *curr_ == '\t')
+                fail("expected a symbol");
+            return *curr_++;
         }
 
-        if (i >= line.size() or line[i] != '-')
-            throw std::runtime_error("Could not parse transition: missing '-' after first counter value. Line: " + line);
-        i++;
-        j = i;
-
-        j = i;
-        while (i < line.size() and isdigit(line[i]))
-            ++i;
-
-        auto counter2_str = line.substr(j, i - j);
-        size_t counter2 = 424242;
-        try {
-            std::stringstream(counter2_str) >> counter2;
-        } catch (std::exception &e) {
-            throw std::runtime_error("Could not parse transition: Error while reading a number (probably empty number). Line: " + line);
+        [[noreturn]] void fail(const std::string &message) const {
+            throw v1ca_parse_error(source_, line_, static_cast<size_t>(curr_ - line_start_) + 1, message);
         }
 
-        for (auto cv = counter1; i <= counter2; ++i) {
-            res.emplace_back(std::make_pair<V1CA::transition_x, V1CA::transition_y>({from, cv, symbol}, {to, V1CA::transition_color::init}));
+        // Remembering a position to report an error on it once the whole token is read
+        [[nodiscard]] const char *mark() const {
+            return curr_;
         }
 
-        return res;
-    }
+        [[noreturn]] void fail_at(const char *position, const std::string &message) {
+            curr_ = position;
+            fail(message);
+        }
 
-    V1CA read_v1ca_from_file(const std::string &path, const visibly_alphabet_t &alphabet) {
-        auto lines = get_all_lines(path);
-        if (lines.size() < 2)
-            throw std::runtime_error("Could not parse V1CA: Not enough lines");
-
-        auto &state_n_line = lines[0];
-        auto &max_lvl_line = lines[1];
-
-        size_t max_lvl = 424242, state_n = 424242;
-        try {
-            std::stringstream(state_n_line) >> state_n;
-            std::stringstream(max_lvl_line) >> max_lvl;
-        } catch (std::exception &e) {
-            throw std::runtime_error("Could not parse V1CA: Could not parse state_n or max_level");
+    private:
+        void next_line() {
+            while (curr_ != end_ and *curr_ != '\n')
+                ++curr_;
+            if (curr_ != end_)
+                ++curr_;
+            line_start_ = curr_;
+            ++line_;
         }
 
-        auto res = V1CA(alphabet);
-        res.states_n_ = state_n;
-        res.max_level_ = max_lvl;
+        const char *curr_;
+        const char *end_;
+        const char *line_start_;
+        size_t line_ = 1;
+        const std::string &source_;
+    };
 
-        // FIXME add actual states props in file
-        for (auto i = 0u; i < state_n; ++i)
-            res.state_props_.insert({i, {0, "x"}});
+    }
+
+    /**
+     * Parse a V1CA in the .v1ca text format, in a single pass over the buffer.
+     * The format is line based, '#' starting a comment:
+     *  - the number of states, then the max level, on the first two lines
+     *  - "state <id> <level> [<name>]" gives the level and name of a state (level 0 and empty name otherwise)
+     *  - "init <id>" sets the initial state (0 otherwise), "final <id>..." adds final states
+     *  - "<from>-><to> <symbol> <counters>" adds a transition, where counters is a counter value "c",
+     *    a range "lo-hi", or "lo+" for every counter value from lo to the max level
+     * @param text The content of the file
+     * @param alphabet The alphabet of the V1CA
+     * @param source The name of the file, used in error messages
+     * @return The parsed V1CA
+     * @throws v1ca_parse_error on the first syntax or consistency error, with its line and column
+     */
+    V1CA read_v1ca_from_buffer(std::string_view text, const visibly_alphabet_t &alphabet,
+                               const std::string &source) {
+        auto cursor = v1ca_cursor(text, source);
+
+        cursor.skip_empty_lines();
+        auto states_n = cursor.number("the number of states");
+        cursor.end_line();
+        cursor.skip_empty_lines();
+        auto max_level = cursor.number("the max level");
+        cursor.end_line();
 
-        for (const auto &line : lines) {
-            if (not line.empty()) {
-                for (auto &trans : read_transition(line))
-                res.transitions_.insert(trans);
+        auto res = V1CA(alphabet);
+        res.states_n_ = states_n;
+        res.max_level_ = max_level;
+        for (auto i = 0u; i < states_n; ++i)
+            res.state_props_.insert({i, {0, ""}});
+
+        const auto read_state = [&cursor, states_n]() {
+            auto position = cursor.mark();
+            auto state = cursor.number("a state");
+            if (state >= states_n)
+                cursor.fail_at(position, "state " + std::to_string(state) + " does not exist, there are "
+                                         + std::to_string(states_n) + " states");
+            return state;
+        };
+
+        while (true) {
+            cursor.skip_empty_lines();
+            if (cursor.at_end())
+                break;
+
+            if (cursor.accept("state")) {
+                cursor.skip_blanks();
+                auto state = read_state();
+                cursor.skip_blanks();
+                auto level = cursor.number("a level");
+                cursor.skip_blanks();
+                res.state_props_[state] = {level, std::string(cursor.word())};
+            } else if (cursor.accept("init")) {
+                cursor.skip_blanks();
+                res.init_state_ = read_state();
+            } else if (cursor.accept("final")) {
+                cursor.skip_blanks();
+                do {
+                    res.final_states_.insert(read_state());
+                    cursor.skip_blanks();
+                } while (not cursor.at_line_end());
+            } else {
+                auto from = read_state();
+                cursor.expect("->");
+                auto to = read_state();
+                cursor.skip_blanks();
+
+                auto symbol_position = cursor.mark();
+                auto symbol = cursor.symbol();
+                if (not alphabet.contains(symbol))
+                    cursor.fail_at(symbol_position, "symbol '" + std::string(1, symbol) + "' is not in the alphabet");
+                cursor.skip_blanks();
+
+                auto counter_position = cursor.mark();
+                auto low = cursor.number("a counter value");
+                auto high = low;
+                if (cursor.accept("+"))
+                    high = max_level;
+                else if (cursor.accept("-"))
+                    high = cursor.number("the end of the counter range");
+                if (low > high or high > max_level)
+                    cursor.fail_at(counter_position, "counter values must be in [0, " + std::to_string(max_level)
+                                                     + "] and ranges must not be empty");
+
+                // A range reaching the max level is taken for every higher counter value as well
+                if (high == max_level)
+                    high = V1CA::transition_func_t::unbounded;
+                auto trans_y = V1CA::transition_y{to, V1CA::transition_color::init};
+                if (res.transitions_.conflicts(from, symbol, low, high, trans_y))
+                    cursor.fail_at(counter_position, "conflicting transition from state " + std::to_string(from)
+                                                     + " with symbol '" + std::string(1, symbol) + "'");
+                res.transitions_.assign(from, symbol, low, high, trans_y);
             }
+            cursor.end_line();
         }
 
         return res;
     }
 
+    /**
+     * Read a V1CA from a .v1ca text file, mapped in memory and parsed in a single pass.
+     * See read_v1ca_from_buffer() for the format.
+     * @param path The path to the file
+     * @param alphabet The alphabet of the V1CA
+     * @return The parsed V1CA
+     * @throws runtime_error if the file cannot be opened, v1ca_parse_error if it is not valid
+     */
+    V1CA read_v1ca_from_file(const std::string &path, const visibly_alphabet_t &alphabet) {
+        auto file = mapped_file(path);
+        return read_v1ca_from_buffer(std::string_view(file.data(), file.size()), alphabet, path);
+    }
+
 }
@@ -0,0 +1,289 @@
+#include "allocation_tracker.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+
+namespace active_learning {
+
+    namespace {
+        // Counters of a phase. They are updated by operator new and delete, so nothing here may allocate.
+        struct phase_counters {
+            std::atomic<const char *> name = nullptr;
+            std::atomic<size_t> allocations = 0;
+            std::atomic<size_t> bytes = 0;
+            std::atomic<size_t> peak_live_bytes = 0;
+        };
+
+        constexpr uint32_t max_phases = 256;
+        // Phase 0 stands for allocations made out of any phase, and for phases beyond max_phases
+        std::array<phase_counters, max_phases> phases;
+        std::atomic<uint32_t> phases_n = 1;
+        std::mutex phases_mutex;
+
+        std::atomic<size_t> live_bytes = 0;
+        std::atomic<size_t> peak_live_bytes = 0;
+
+        thread_local uint32_t current_phase = 0;
+
+        /**
+         * Index of the counters of a phase, added on the first call with this name. Names are compared by
+         * address first, as they are string literals.
+         */
+        uint32_t phase_index(const char *name) {
+            auto n = phases_n.load(std::memory_order_acquire);
+            for (auto i = 1u; i < n; ++i) {
+                if (phases[i].name.load(std::memory_order_relaxed) == name)
+                    return i;
+            }
+
+            auto lock = std::unique_lock(phases_mutex);
+            n = phases_n.load(std::memory_order_relaxed);
+            for (auto i = 1u; i < n; ++i) {
+                if (std::strcmp(phases[i].name.load(std::memory_order_relaxed), name) == 0)
+                    return i;
+            }
+            if (n == max_phases)
+                return 0;
+
+            phases[n].name.store(name, std::memory_order_relaxed);
+            phases_n.store(n + 1, std::memory_order_release);
+            return n;
+        }
+
+        std::string_view subsystem_of(std::string_view phase) {
+            auto separator = phase.find("::");
+            return (separator == std::string_view::npos) ? phase : phase.substr(0, separator);
+        }
+    }
+
+#ifdef V1C2AL_ALLOC_TRACKING
+    namespace {
+        // Blocks start with a header holding their size and the phase they were allocated in, which keeps the
+        // default alignment of new
+        struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) block_header {
+            size_t size;
+            uint32_t phase;
+        };
+
+        void raise(std::atomic<size_t> &peak, size_t value) {
+            auto current = peak.load(std::memory_order_relaxed);
+            while (current < value and !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+
+        void *tracked_allocate(size_t size) {
+            auto *header = static_cast<block_header *>(std::malloc(sizeof(block_header) + size));
+            if (!header)
+                return nullptr;
+
+            header->size = size;
+            header->phase = current_phase;
+            auto &counters = phases[header->phase];
+            counters.allocations.fetch_add(1, std::memory_order_relaxed);
+            counters.bytes.fetch_add(size, std::memory_order_relaxed);
+            auto live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+            raise(peak_live_bytes, live);
+            raise(counters.peak_live_bytes, live);
+
+            return header + 1;
+        }
+
+        void tracked_free(void *ptr) {
+            if (!ptr)
+                return;
+
+            auto *header = static_cast<block_header *>(ptr) - 1;
+            live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+            std::free(header);
+        }
+    }
+#endif
+
+    allocation_tracker &allocation_tracker::get_default() {
+        static allocation_tracker tracker;
+        return tracker;
+    }
+
+    bool allocation_tracker::is_enabled() {
+#ifdef V1C2AL_ALLOC_TRACKING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @return The counters of every phase that was entered, and of the "(none)" phase
+     */
+    std::vector<allocation_tracker::phase_stats> allocation_tracker::get_phases() const {
+        auto res = std::vector<phase_stats>();
+        auto n = phases_n.load(std::memory_order_acquire);
+        for (auto i = 0u; i < n; ++i) {
+            const auto *name = phases[i].name.load(std::memory_order_relaxed);
+            res.push_back({(i == 0) ? "(none)" : name,
+                           phases[i].allocations.load(std::memory_order_relaxed),
+                           phases[i].bytes.load(std::memory_order_relaxed),
+                           phases[i].peak_live_bytes.load(std::memory_order_relaxed)});
+        }
+
+        return res;
+    }
+
+    /**
+     * @return The counters of the phases summed by subsystem, the peak being the highest one of the phases
+     */
+    std::vector<allocation_tracker::phase_stats> allocation_tracker::get_subsystems() const {
+        auto subsystems = std::map<std::string, phase_stats>();
+        for (const auto &phase : get_phases()) {
+            auto name = std::string(subsystem_of(phase.name));
+            auto &subsystem = subsystems[name];
+            subsystem.name = name;
+            subsystem.allocations += phase.allocations;
+            subsystem.bytes += phase.bytes;
+            subsystem.peak_live_bytes = std::max(subsystem.peak_live_bytes, phase.peak_live_bytes);
+        }
+
+        auto res = std::vector<phase_stats>();
+        for (auto &[name, subsystem] : subsystems)
+            res.push_back(std::move(subsystem));
+
+        return res;
+    }
+
+    size_t allocation_tracker::get_live_bytes() const {
+        return live_bytes.load(std::memory_order_relaxed);
+    }
+
+    size_t allocation_tracker::get_peak_live_bytes() const {
+        return peak_live_bytes.load(std::memory_order_relaxed);
+    }
+
+    // Start measuring a new peak from the bytes live now, phases having no peak until they allocate again
+    void allocation_tracker::reset_peak() {
+        peak_live_bytes.store(get_live_bytes(), std::memory_order_relaxed);
+        auto n = phases_n.load(std::memory_order_acquire);
+        for (auto i = 0u; i < n; ++i)
+            phases[i].peak_live_bytes.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Record the footprint of a round, along with the memory live at the end of it
+     */
+    void allocation_tracker::add_round(round_stats round) {
+        round.live_bytes = get_live_bytes();
+        round.peak_live_bytes = get_peak_live_bytes();
+
+        auto lock = std::unique_lock(mutex_);
+        rounds_.push_back(round);
+    }
+
+    std::vector<allocation_tracker::round_stats> allocation_tracker::get_rounds() const {
+        auto lock = std::unique_lock(mutex_);
+        return rounds_;
+    }
+
+    /**
+     * Write the phases, subsystems and rounds as JSON
+     * @throws runtime_error if the file cannot be opened
+     */
+    void allocation_tracker::write_summary(const std::string &path) const {
+        std::ofstream out;
+        out.open(path);
+        if (!out.is_open())
+            throw std::runtime_error("write_summary(): Could not open '" + path + "'.");
+
+        const auto write_phases = [&out](const std::vector<phase_stats> &list) {
+            for (auto i = 0ul; i < list.size(); ++i) {
+                out << (i ? ",\n" : "\n") << R"(    {"name":")" << list[i].name
+                    << R"(","allocations":)" << list[i].allocations
+                    << R"(,"bytes":)" << list[i].bytes
+                    << R"(,"peak_live_bytes":)" << list[i].peak_live_bytes << '}';
+            }
+        };
+
+        out << "{\n  \"live_bytes\": " << get_live_bytes()
+            << ",\n  \"peak_live_bytes\": " << get_peak_live_bytes()
+            << ",\n  \"phases\": [";
+        write_phases(get_phases());
+        out << "\n  ],\n  \"subsystems\": [";
+        write_phases(get_subsystems());
+        out << "\n  ],\n  \"rounds\": [";
+
+        auto rounds = get_rounds();
+        for (auto i = 0ul; i < rounds.size(); ++i) {
+            const auto &round = rounds[i];
+            out << (i ? ",\n" : "\n") << R"(    {"round":)" << round.round
+                << R"(,"rst_tables":)" << round.rst_tables
+                << R"(,"rst_cells":)" << round.rst_cells
+                << R"(,"rst_cell_bytes":)" << round.rst_cell_bytes
+                << R"(,"rst_label_bytes":)" << round.rst_label_bytes
+                << R"(,"queries":)" << round.queries
+                << R"(,"graph_vertices":)" << round.graph_vertices
+                << R"(,"graph_edges":)" << round.graph_edges
+                << R"(,"live_bytes":)" << round.live_bytes
+                << R"(,"peak_live_bytes":)" << round.peak_live_bytes << '}';
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    allocation_scope::allocation_scope(const char *phase) : parent_(current_phase) {
+        current_phase = phase_index(phase);
+    }
+
+    allocation_scope::~allocation_scope() {
+        current_phase = parent_;
+    }
+}
+
+#ifdef V1C2AL_ALLOC_TRACKING
+void *operator new(size_t size) {
+    auto *ptr = active_learning::tracked_allocate(size);
+    if (!ptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return active_learning::tracked_allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return active_learning::tracked_allocate(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    active_learning::tracked_free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    active_learning::tracked_free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    active_learning::tracked_free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    active_learning::tracked_free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    active_learning::tracked_free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    active_learning::tracked_free(ptr);
+}
+#endif
@@ -2,6 +2,11 @@
 
 #include <utility>
 #include <iostream>
+#include <stdexcept>
+
+#if defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
 
 namespace active_learning {
     bool basic_alphabet::contains(char symbol) const {
@@ -15,25 +20,101 @@ namespace active_learning {
     basic_alphabet::basic_alphabet(std::set<char> symbols) : symbols_(std::move(symbols)) {}
 
     bool visibly_alphabet::contains(char symbol) const {
-        return symbols_and_values_.contains(symbol);
+        return known_[static_cast<unsigned char>(symbol)];
     }
 
     int visibly_alphabet::get_cv(char symbol) const {
-        return symbols_and_values_.at(symbol);
+        auto index = static_cast<unsigned char>(symbol);
+        if (not known_[index])
+            throw std::out_of_range(std::string("visibly_alphabet::get_cv(): unknown symbol '") + symbol + "'.");
+
+        return cv_table_[index];
     }
 
     int visibly_alphabet::get_cv(const std::string &word) const {
-        int res = 0;
-        for (char c : word)
-            res += symbols_and_values_.at(c);
+        return get_cv_summary(word).cv;
+    }
+
+    std::vector<int> visibly_alphabet::get_prefixes_cv(const std::string &word) const {
+        auto res = std::vector<int>();
+        get_cv_summary(word, &res);
 
         return res;
     }
 
+    /**
+     * Compute in a single pass the counter value of a word and the lowest counter value reached by one
+     * of its prefixes. Symbols are looked up in the cv table, and running sums are computed 4 by 4
+     * using a SSE prefix-sum when available.
+     * @param word The word to be processed
+     * @param prefixes_cv If not null, filled with the counter value of every prefix of the word,
+     * from "" (index 0) to the word itself (index word.size())
+     * @return The counter value of the word and the minimum counter value of its prefixes
+     * @throws out_of_range if the word contains a symbol that is not in the alphabet
+     */
+    visibly_alphabet::cv_summary
+    visibly_alphabet::get_cv_summary(const std::string &word, std::vector<int> *prefixes_cv) const {
+        const auto n = word.size();
+        const auto *symbols = reinterpret_cast<const unsigned char *>(word.data());
+        int *prefixes = nullptr;
+        if (prefixes_cv) {
+            prefixes_cv->resize(n + 1);
+            (*prefixes_cv)[0] = 0;
+            prefixes = prefixes_cv->data() + 1;
+        }
+
+        auto valid = true;
+        auto cv = 0;
+        auto min_cv = 0;
+        auto i = 0ul;
+
+#if defined(__SSE4_1__)
+        auto carry = _mm_setzero_si128();
+        auto v_min = _mm_setzero_si128();
+        for (; i + 4 <= n; i += 4) {
+            valid &= known_[symbols[i]] & known_[symbols[i + 1]] & known_[symbols[i + 2]] & known_[symbols[i + 3]];
+
+            auto v = _mm_setr_epi32(cv_table_[symbols[i]], cv_table_[symbols[i + 1]],
+                                    cv_table_[symbols[i + 2]], cv_table_[symbols[i + 3]]);
+            // In-register prefix sum, then adding the running sum of the previous blocks
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi32(v, carry);
+
+            if (prefixes)
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(prefixes + i), v);
+            v_min = _mm_min_epi32(v_min, v);
+            carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+        v_min = _mm_min_epi32(v_min, _mm_shuffle_epi32(v_min, _MM_SHUFFLE(1, 0, 3, 2)));
+        v_min = _mm_min_epi32(v_min, _mm_shuffle_epi32(v_min, _MM_SHUFFLE(2, 3, 0, 1)));
+        min_cv = _mm_cvtsi128_si32(v_min);
+        cv = _mm_cvtsi128_si32(carry);
+#endif
+
+        for (; i < n; ++i) {
+            valid &= known_[symbols[i]];
+            cv += cv_table_[symbols[i]];
+            if (prefixes)
+                prefixes[i] = cv;
+            if (cv < min_cv)
+                min_cv = cv;
+        }
+
+        if (not valid) {
+            for (char c : word)
+                get_cv(c); // Throws on the first unknown symbol
+        }
+
+        return {cv, min_cv};
+    }
+
     visibly_alphabet::visibly_alphabet(const std::map<char, int>& symbolsAndValues) {
         symbols_and_values_ = symbolsAndValues;
         for (auto c : symbols_and_values_) {
             symbols_.insert(c.first);
+            cv_table_[static_cast<unsigned char>(c.first)] = c.second;
+            known_[static_cast<unsigned char>(c.first)] = true;
         }
     }
 
@@ -1,16 +1,28 @@
 #include "behaviour_graph.h"
 #include "dataframe.h"
+#include "v1ca_behaviour_view.h"
 
-#include <boost/graph/graphviz.hpp>
-#include <fstream>
 #include <dot_writers.h>
+#include <visualization_sink.h>
+#include <trace.h>
 #include <queue>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <chrono>
+#include <thread>
 
 namespace active_learning {
 
     // Constructors
     bg_vertex_attr::bg_vertex_attr(const std::string &name, int level) : name(name), level(level) {}
 
+    bg_vertex_attr::bg_vertex_attr(const std::string &name, int level, size_t id, unsigned char flags) : name(name),
+                                                                                                          level(level),
+                                                                                                          id(id),
+                                                                                                          flags(flags) {}
+
     bg_vertex_attr::bg_vertex_attr() = default;
 
     bg_edge_attr::bg_edge_attr(char symbol, int effect) : symbol(symbol), effect(effect) {}
@@ -19,316 +31,872 @@ namespace active_learning {
 
     bg_edge_attr::bg_edge_attr() = default;
 
-    behaviour_graph::behaviour_graph() : displayable(displayable_type::behaviour_graph) {}
+    behaviour_graph::behaviour_graph() : displayable(displayable_type::behaviour_graph) {
+        freeze();
+    }
 
     behaviour_graph::behaviour_graph(const vertexes_t &states,
                                      const edges_t &edges,
                                      const std::string &init_state,
                                      std::set<std::string> final_states) : displayable(
             displayable_type::behaviour_graph) {
-        // Adding initial state
-        init_state_ = init_state;
-        // Adding final states
-        for (auto &e : final_states) {
-            this->final_states_.insert(e);
-        }
-
-        std::map<std::string, vertex_descriptor_t> name_to_desc;
-
-        // Adding vertexes to graph
+        // Adding vertexes to graph, ids being their index in states
+        name_to_id_.reserve(states.size());
         for (auto &v : states) {
-            auto new_v = boost::add_vertex(bg_vertex_attr(v.first, v.second), graph_);
-            name_to_desc[v.first] = new_v;
+            auto flags = static_cast<unsigned char>(0);
+            if (v.first == init_state)
+                flags |= bg_vertex_attr::init_flag;
+            if (final_states.contains(v.first))
+                flags |= bg_vertex_attr::final_flag;
+
+            auto new_v = boost::add_vertex(bg_vertex_attr(v.first, v.second, name_to_id_.size(), flags), graph_);
+            name_to_id_[v.first] = graph_[new_v].id;
 
             if (static_cast<size_t>(v.second) > max_level_)
                 max_level_ = v.second;
         }
 
-        // Adding edges to graph
+        // Adding edges to graph, vertex descriptors and ids being the same until a vertex is deleted
         for (auto &e : edges) {
-            vertex_descriptor_t src = name_to_desc[std::get<0>(e)];
-            vertex_descriptor_t dest = name_to_desc[std::get<3>(e)];
+            vertex_descriptor_t src = name_to_id_.at(std::get<0>(e));
+            vertex_descriptor_t dest = name_to_id_.at(std::get<3>(e));
             char symbol = std::get<1>(e);
             int effect = std::get<2>(e);
             auto new_edge = boost::add_edge(src, dest, bg_edge_attr(symbol, effect), graph_);
             if (!new_edge.second)
                 throw std::runtime_error("Could not add edge while creating R1CA, boost won't allow it");
         }
+
+        freeze();
+    }
+
+    /**
+     * Build the CSR index of the graph, which is needed by every lookup on edges.
+     * This has to be called again after any change to the vertices or edges of graph_.
+     */
+    void behaviour_graph::freeze() {
+        const auto vertices_n = boost::num_vertices(graph_);
+        const auto edges_n = boost::num_edges(graph_);
+        auto csr = csr_t();
+
+        // Indexing the symbols that are used
+        csr.symbol_index.fill(-1);
+        for (auto ep = boost::edges(graph_); ep.first != ep.second; ++ep.first) {
+            auto &index = csr.symbol_index[static_cast<unsigned char>(graph_[*ep.first].symbol)];
+            if (index < 0)
+                index = static_cast<int>(csr.symbols_n++);
+        }
+
+        csr.out_offsets.assign(vertices_n + 1, 0);
+        csr.in_offsets.assign(vertices_n + 1, 0);
+        csr.out_targets.resize(edges_n);
+        csr.out_symbols.resize(edges_n);
+        csr.in_sources.resize(edges_n);
+        csr.in_symbols.resize(edges_n);
+        csr.next.assign(vertices_n * csr.symbols_n, csr_t::none);
+        csr.prev.assign(vertices_n * csr.symbols_n, csr_t::none);
+
+        for (auto ep = boost::edges(graph_); ep.first != ep.second; ++ep.first) {
+            ++csr.out_offsets[boost::source(*ep.first, graph_) + 1];
+            ++csr.in_offsets[boost::target(*ep.first, graph_) + 1];
+        }
+        for (auto v = 0ul; v < vertices_n; ++v) {
+            csr.out_offsets[v + 1] += csr.out_offsets[v];
+            csr.in_offsets[v + 1] += csr.in_offsets[v];
+        }
+
+        // Filling rows, keeping the first successor and predecessor found for each symbol
+        auto out_pos = std::vector<size_t>(csr.out_offsets.begin(), csr.out_offsets.end() - 1);
+        auto in_pos = std::vector<size_t>(csr.in_offsets.begin(), csr.in_offsets.end() - 1);
+        for (auto ep = boost::edges(graph_); ep.first != ep.second; ++ep.first) {
+            auto src = boost::source(*ep.first, graph_);
+            auto dst = boost::target(*ep.first, graph_);
+            auto symbol = graph_[*ep.first].symbol;
+            auto symbol_index = static_cast<size_t>(csr.symbol_index[static_cast<unsigned char>(symbol)]);
+
+            csr.out_targets[out_pos[src]] = dst;
+            csr.out_symbols[out_pos[src]++] = symbol;
+            csr.in_sources[in_pos[dst]] = src;
+            csr.in_symbols[in_pos[dst]++] = symbol;
+
+            auto &next = csr.next[src * csr.symbols_n + symbol_index];
+            if (next == csr_t::none)
+                next = dst;
+            auto &prev = csr.prev[dst * csr.symbols_n + symbol_index];
+            if (prev == csr_t::none)
+                prev = src;
+        }
+
+        csr_ = std::move(csr);
+
+        // Bucketing vertices by level
+        auto levels_n = max_level_ + 1;
+        for (auto v = 0ul; v < vertices_n; ++v)
+            levels_n = std::max(levels_n, level(v) + 1);
+        level_offsets_.assign(levels_n + 1, 0);
+        for (auto v = 0ul; v < vertices_n; ++v)
+            ++level_offsets_[level(v) + 1];
+        for (auto l = 0ul; l < levels_n; ++l)
+            level_offsets_[l + 1] += level_offsets_[l];
+        level_order_.resize(vertices_n);
+        level_rank_.resize(vertices_n);
+        auto level_pos = std::vector<size_t>(level_offsets_.begin(), level_offsets_.end() - 1);
+        for (auto v = 0ul; v < vertices_n; ++v) {
+            level_rank_[v] = level_pos[level(v)]++;
+            level_order_[level_rank_[v]] = v;
+        }
+
+        // Mapping ids to the current vertex descriptors
+        id_to_vertex_.assign(name_to_id_.size(), csr_t::none);
+        init_vertex_ = csr_t::none;
+        for (auto v = 0ul; v < vertices_n; ++v) {
+            id_to_vertex_[graph_[v].id] = v;
+            if (graph_[v].flags & bg_vertex_attr::init_flag)
+                init_vertex_ = v;
+        }
     }
 
     // Others
     behaviour_graph::vertex_descriptor_t behaviour_graph::find_vertex_by_name(const std::string &name) {
-        for (auto vi = boost::vertices(graph_); vi.first != vi.second; ++vi.first) {
-            if (graph_[*vi.first].name == name) {
-                return *vi.first;
-            }
-        }
+        auto found = name_to_id_.find(name);
+        if (found == name_to_id_.end() or id_to_vertex_[found->second] == csr_t::none)
+            throw std::invalid_argument("Could not find state with name '" + name + "'.");
 
-        throw std::invalid_argument("Could not find state with name '" + name + "'.");
+        return id_to_vertex_[found->second];
     }
 
     behaviour_graph::graph_t &behaviour_graph::get_mutable_graph() {
         return graph_;
     }
 
+    /**
+     * Export the behaviour graph as a .dot file, and a .png file depending on the mode of the visualization sink.
+     * Files are written in the background.
+     * @param path The path to the png and dot file, without the extension
+     */
     void behaviour_graph::display(const std::string &path) {
-        // Writing dot file
-        std::string full_path = path + ".dot";
-        std::ofstream file;
-        file.open(full_path);
-        auto dummy_alphabet = basic_alphabet();
-        boost::write_graphviz(file, graph_,
-                              vertex_writer((displayable &) *this),
-                              edge_writer((displayable &) *this));
+        auto &sink = visualization_sink::get_default();
+        if (!sink.is_enabled())
+            return;
+
+        auto out = dot_buffer();
+        writer::write_behaviour_graph(out, *this);
+        sink.submit(path, out.release());
+    }
+
+    bool behaviour_graph::is_final(const std::string &v_name) const {
+        auto found = name_to_id_.find(v_name);
+        return found != name_to_id_.end() and id_to_vertex_[found->second] != csr_t::none
+               and is_final(id_to_vertex_[found->second]);
+    }
+
+    bool behaviour_graph::is_init(const std::string &v_name) const {
+        auto found = name_to_id_.find(v_name);
+        return found != name_to_id_.end() and id_to_vertex_[found->second] != csr_t::none
+               and is_init(id_to_vertex_[found->second]);
+    }
+
+    bool behaviour_graph::is_final(vertex_descriptor_t v) const {
+        return graph_[v].flags & bg_vertex_attr::final_flag;
+    }
+
+    bool behaviour_graph::is_init(vertex_descriptor_t v) const {
+        return graph_[v].flags & bg_vertex_attr::init_flag;
+    }
+
+    const std::string &behaviour_graph::name(vertex_descriptor_t v) const {
+        return graph_[v].name;
+    }
+
+    size_t behaviour_graph::id(vertex_descriptor_t v) const {
+        return graph_[v].id;
+    }
 
-        // Creating png file
-        // Hoping that you are on linux and have dot installed
-        system(("dot -Tpng " + full_path + " > " + path + ".png").c_str());
+    size_t behaviour_graph::level(vertex_descriptor_t v) const {
+        return graph_[v].level;
     }
 
-    bool behaviour_graph::is_final(const std::string &v_name) {
-        return final_states_.contains(v_name);
+    size_t behaviour_graph::vertices_n() const {
+        return boost::num_vertices(graph_);
     }
 
-    bool behaviour_graph::is_init(const std::string &v_name) {
-        return v_name == init_state_;
+    size_t behaviour_graph::edges_n() const {
+        return boost::num_edges(graph_);
     }
 
     /**
-     * Get the edges of a behaviour graph using a RST.
-     * @param no_dup_rst The source RST with no duplicated rows
-     * @param alphabet The reference target language alphabet
-     * @param states A list of the states of the result behaviour graph
+     * @throws invalid_argument if the vertex with this id was deleted
+     */
+    behaviour_graph::vertex_descriptor_t behaviour_graph::vertex_of(size_t id) const {
+        if (id >= id_to_vertex_.size() or id_to_vertex_[id] == csr_t::none)
+            throw std::invalid_argument("Could not find state with id " + std::to_string(id) + ".");
+
+        return id_to_vertex_[id];
+    }
+
+    /**
+     * Get the edges leaving some vertices of a behaviour graph using a RST.
+     * Successors are resolved in bulk: they are grouped by level, the rows of the ones that are not rows of the
+     * RST are filled with a single batch of queries, then each level is mapped to its classes on its own thread.
+     * Successors above the top table of the RST are left out, and their sources remembered until the RST grows.
+     * @param rst The source RST
+     * @param sources The ids of the vertices whose edges are needed
      * @param teacher A teacher that may be used for membership queries
-     * @return A set of edges deduced from the RST
+     * @param alphabet The reference target language alphabet
+     * @return A set of edges deduced from the RST, sorted by level of their destination
      */
     behaviour_graph::edges_t
-    behaviour_graph::get_edges_from_rst(RST &no_dup_rst, word_counter &wc, vertexes_t &states, teacher &teacher,
-                                        alphabet &alphabet) {
-        edges_t res;
-        for (auto &st : states) {
-            auto &src = st.first;
+    behaviour_graph::get_edges_from_rst(const RST &rst, word_counter &wc, const std::set<size_t> &sources,
+                                        teacher &teacher, alphabet &alphabet) {
+        V1C2AL_TRACE_SPAN("behaviour_graph::get_edges_from_rst");
+        V1C2AL_TRACE_ARG("sources", sources.size());
+        // Successor words of the sources, grouped by counter value, along with their source and symbol
+        auto words_per_level = std::vector<std::vector<std::string>>(rst.size());
+        auto edges_per_level = std::vector<edges_t>(rst.size());
+        for (auto src_id : sources) {
+            const auto &src = name(vertex_of(src_id));
             for (auto &c : alphabet.symbols()) {
                 auto dest_word = src + c;
                 int cv = wc.get_cv(dest_word);
 
-                if (cv >= static_cast<int>(no_dup_rst.size()) or cv < 0) {
+                if (cv < 0)
+                    continue;
+                if (cv >= static_cast<int>(rst.size())) {
+                    rst_sync_.below_top.insert(src_id);
                     continue;
                 }
 
-                // RST is closed: the should be a destination to src
-                auto dest = find_state_from_word(no_dup_rst, dest_word, cv, teacher);
-
                 auto char_as_str = std::string() + c;
-                res.emplace_back(std::make_tuple(src, c, wc.get_cv(char_as_str), dest));
+                words_per_level[cv].push_back(dest_word);
+                edges_per_level[cv].emplace_back(std::make_tuple(src, c, wc.get_cv(char_as_str), std::string()));
             }
         }
 
+        query_missing_rows(rst, words_per_level, teacher);
+
+        // RST is closed: there should be a destination to every successor. Levels only read the RST and the
+        // classes, so they are resolved in parallel when there are enough words to pay for the threads.
+        auto levels = std::vector<size_t>();
+        auto words_n = 0ul;
+        for (auto cv = 0ul; cv < rst.size(); ++cv) {
+            if (!words_per_level[cv].empty())
+                levels.push_back(cv);
+            words_n += words_per_level[cv].size();
+        }
+        auto errors = std::vector<std::exception_ptr>(levels.size());
+        auto next = std::atomic<size_t>(0);
+        const auto worker = [&]() {
+            for (auto i = next++; i < levels.size(); i = next++) {
+                auto cv = levels[i];
+                try {
+                    for (auto e = 0ul; e < words_per_level[cv].size(); ++e) {
+                        auto dest = find_state_from_word(rst, words_per_level[cv][e], static_cast<int>(cv));
+                        std::get<3>(edges_per_level[cv][e]) = name(vertex_of(dest));
+                    }
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+
+        auto threads_n = (words_n < parallel_words_min)
+                         ? 1ul : std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), levels.size());
+        auto threads = std::vector<std::thread>();
+        for (auto t = 1ul; t < threads_n; ++t)
+            threads.emplace_back(worker);
+        worker();
+        for (auto &thread : threads)
+            thread.join();
+
+        edges_t res;
+        for (auto i = 0ul; i < levels.size(); ++i) {
+            if (errors[i])
+                std::rethrow_exception(errors[i]);
+            auto &level_edges = edges_per_level[levels[i]];
+            res.insert(res.end(), std::make_move_iterator(level_edges.begin()),
+                       std::make_move_iterator(level_edges.end()));
+        }
+
         return res;
     }
 
     /**
-     * Find the name of the corresponding row in a RST from a given word.
-     * Note that the given word may not be the name of a row of the RST.
+     * Fill the rows of the words that are not rows of the RST, on the columns of their table, with a single batch
+     * of membership queries. Values queried are kept, so a word is only queried again on the columns added since.
+     * @param words_per_level Words to be looked up later, per counter value
+     */
+    void behaviour_graph::query_missing_rows(const RST &rst, const std::vector<std::vector<std::string>> &words_per_level,
+                                             teacher &teacher) {
+        auto queries = std::vector<std::string>();
+        auto targets = std::vector<std::vector<bool> *>();
+        for (auto cv = 0ul; cv < words_per_level.size(); ++cv) {
+            const auto &col_labels = rst.get_ctables()[cv].get_col_labels();
+            const auto &rows = rst_sync_.rows[cv];
+            for (const auto &word : words_per_level[cv]) {
+                if (rows.contains(word))
+                    continue;
+
+                // A word may be the successor of several sources, its queries are only asked once
+                auto &probe = rst_sync_.probes[word];
+                if (probe.size() >= col_labels.size())
+                    continue;
+                auto known = probe.size();
+                probe.resize(col_labels.size());
+                for (auto col_i = known; col_i < col_labels.size(); ++col_i) {
+                    queries.push_back(word + col_labels[col_i]);
+                    targets.push_back(&probe);
+                }
+            }
+        }
+        if (queries.empty())
+            return;
+
+        // Answers are stored in the order of queries, the columns of a word being contiguous
+        auto answers = teacher.membership_queries(queries);
+        auto answer_i = 0ul;
+        while (answer_i < answers.size()) {
+            auto *probe = targets[answer_i];
+            auto cols_n = 0ul;
+            while (answer_i + cols_n < answers.size() and targets[answer_i + cols_n] == probe)
+                ++cols_n;
+            for (auto col_i = 0ul; col_i < cols_n; ++col_i)
+                (*probe)[probe->size() - cols_n + col_i] = answers[answer_i + col_i];
+            answer_i += cols_n;
+        }
+    }
+
+    /**
+     * Find the vertex of the class of rows a word belongs to.
+     * Note that the given word may not be the name of a row of the RST, in which case its row must have been
+     * queried first.
      * @param rst The source RST
-     * @param state_word The word which row needs to be found
+     * @param state_word The word whose class needs to be found
      * @param cv The counter value of the state_word
-     * @param teacher A teacher that may be used for membership queries.
-     * @return The name and cv of the matching row as a V1CA_Vertex object
+     * @return The id of the vertex of the class
      * @throws invalid_argument if the cv is incorrect
      * @throws runtime_error if no matching state was found. This may be due to a RST that was not closed
      * or an out of context state_word.
      */
-    std::string
-    behaviour_graph::find_state_from_word(RST &rst, const std::string &state_word, int cv, teacher &teacher) {
-
+    size_t behaviour_graph::find_state_from_word(const RST &rst, const std::string &state_word, int cv) const {
         if (cv < 0 or cv >= static_cast<int>(rst.size()))
             throw std::invalid_argument("find_state_from_word(): cv out of bound of RST.");
 
-        const auto &cv_table = rst.get_ctables()[cv];
-        auto word_pos = std::find(cv_table.get_row_labels().begin(), cv_table.get_row_labels().end(), state_word);
-        if (word_pos != cv_table.get_row_labels().end())
-            return state_word;
+        const auto &classes = rst_sync_.classes[cv];
+        auto found = classes.find(get_row_of_word(rst, state_word, cv));
+        if (found == classes.end())
+            throw std::runtime_error("find_state_from_word(): Could not find a matching row in RST."
+                                     " Either the RST is not closed, or the word that was asked is out of context.");
+
+        return found->second;
+    }
 
-        auto rst_cp = RST(rst);
-        rst_cp.add_row_using_query(state_word, cv, teacher, "find_state");
-        auto &cp_table = rst_cp.get_tables()[cv];
-        // Works by knowing that our word got inserted as last index
-        auto &word_row = cp_table.get_data()[cp_table.get_row_labels().size() - 1];
+    /**
+     * Get the values of a word on the columns of its table, from its row if it has one, or else from its
+     * queried values
+     * @throws out_of_range if the word is not a row and was never queried
+     */
+    const std::vector<bool> &behaviour_graph::get_row_of_word(const RST &rst, const std::string &word, int cv) const {
+        const auto &rows = rst_sync_.rows[cv];
+        auto row_i = rows.find(word);
+        if (row_i != rows.end())
+            return rst.get_ctables()[cv].get_cdata()[row_i->second];
 
-        // Comparing every row to find duplicate
-        for (auto i = 0u; i < cp_table.get_data().size() - 1; ++i) {
-            auto &row_i = cp_table.get_data()[i];
+        return rst_sync_.probes.at(word);
+    }
 
-            if (row_i == word_row)
-                return cp_table.get_row_labels()[i];
+    /**
+     * Put a row of a RST in its class, adding a vertex if the row is the first of a new class.
+     * A row that was already the first of its class keeps its vertex when classes are rebuilt.
+     * @param dirty The ids of the vertices whose edges need to be computed, where a new vertex is added
+     */
+    void behaviour_graph::classify_row(const RST &rst, int cv, size_t row_i, std::set<size_t> &dirty) {
+        const auto &table = rst.get_ctables()[cv];
+        auto &classes = rst_sync_.classes[cv];
+        const auto &row = table.get_cdata()[row_i];
+        if (classes.contains(row))
+            return;
+
+        const auto &word = table.get_row_labels()[row_i];
+        auto known = name_to_id_.find(word);
+        if (known != name_to_id_.end()) {
+            classes[row] = known->second;
+            return;
         }
 
-        throw std::runtime_error("find_state_from_word(): Could not find a matching row in RST."
-                                 " Either the RST is not closed, or the word that was asked is out of context.");
-    }
+        auto flags = static_cast<unsigned char>(0);
+        if (word.empty())
+            flags |= bg_vertex_attr::init_flag;
+        if (cv == 0 and table.at(row_i, ""))
+            flags |= bg_vertex_attr::final_flag;
 
-    behaviour_graph::behaviour_graph(RST &rst, word_counter &wc, teacher &teacher, alphabet &alphabet) : displayable(
-            displayable_type::behaviour_graph) {
+        auto id = name_to_id_.size();
+        auto new_v = boost::add_vertex(bg_vertex_attr(word, cv, id, flags), graph_);
+        name_to_id_[word] = id;
+        id_to_vertex_.push_back(new_v);
+        max_level_ = std::max(max_level_, static_cast<size_t>(cv));
 
-        // Removing duplicate rows
-        RST no_dup_rst = rst.remove_duplicate_rows();
+        classes[row] = id;
+        dirty.insert(id);
+    }
 
-        // Building vertexes
-        std::vector<std::pair<std::string, int>> vertexes;
-        for (auto i = 0u; i < no_dup_rst.get_tables().size(); ++i) {
-            auto &table = no_dup_rst.get_tables()[i];
-            for (auto &word : table.get_row_labels()) {
-                vertexes.emplace_back(word, i);
+    /**
+     * Build a behaviour graph from the whole journal of a RST
+     * @see update()
+     */
+    behaviour_graph::behaviour_graph(RST &rst, word_counter &wc, teacher &teacher, alphabet &alphabet)
+            : behaviour_graph() {
+        update(rst, wc, teacher, alphabet);
+    }
+
+    /**
+     * Bring the graph up to date with the changes made to a RST since the last update, the graph being the
+     * one of the RST without its duplicate rows. Vertices are the first rows of the classes of rows of each table.
+     * As rows and columns are only ever added to a RST, classes only split and vertices are never removed:
+     *   - a new row is either in a known class, or the first row of a new class that gets a new vertex,
+     *   - a new column splits classes of its table, whose edges coming from other vertices are recomputed,
+     *   - a new table brings successors that were above the top table into the RST.
+     * Only the edges of the vertices affected by these changes are recomputed, and words that are not rows of
+     * the RST are only queried on the columns added since they were last asked.
+     * @param rst The RST, always the same one, whose journal is read from where the last update stopped. The
+     * changes applied are then trimmed from it.
+     * @param teacher A teacher that may be used for membership queries
+     * @throws invalid_argument if the journal of the RST does not hold the changes since the last update
+     */
+    void behaviour_graph::update(RST &rst, word_counter &wc, teacher &teacher, alphabet &alphabet) {
+        V1C2AL_TRACE_SPAN("behaviour_graph::update");
+        const auto &journal = rst.get_journal();
+        if (rst_sync_.journal_pos < rst.journal_begin() or rst_sync_.journal_pos > rst.journal_begin() + journal.size())
+            throw std::invalid_argument("update(): The RST is not the one the behaviour graph is maintained from.");
+
+        auto grown = false;
+        auto split_tables = std::set<int>();
+        auto new_rows = std::vector<std::pair<int, size_t>>();
+        for (auto i = rst_sync_.journal_pos - rst.journal_begin(); i < journal.size(); ++i) {
+            const auto &change = journal[i];
+            switch (change.what) {
+                case RST::change::kind::table:
+                    grown = true;
+                    break;
+                case RST::change::kind::row:
+                    new_rows.emplace_back(change.cv, change.index);
+                    break;
+                case RST::change::kind::col:
+                    split_tables.insert(change.cv);
+                    break;
             }
         }
-
-        // Final states
-        std::set<std::string> final_states;
-        auto &table0 = no_dup_rst.get_tables()[0];
-        auto &table0_rows = table0.get_row_labels();
-        for (auto i = 0u; i < table0_rows.size(); ++i) {
-            if (table0.at(i, "")) {
-                final_states.insert(table0_rows[i]);
+        rst_sync_.journal_pos = rst.journal_begin() + journal.size();
+        rst.trim_journal(rst_sync_.journal_pos);
+        rst_sync_.classes.resize(rst.size());
+        rst_sync_.rows.resize(rst.size());
+
+        auto dirty = std::set<size_t>();
+        for (const auto &[cv, row_i] : new_rows)
+            rst_sync_.rows[cv].emplace(rst.get_ctables()[cv].get_row_labels()[row_i], row_i);
+
+        // Classes of a table with new columns are rebuilt, and edges going to this table recomputed
+        for (auto cv : split_tables) {
+            rst_sync_.classes[cv].clear();
+            for (auto row_i = 0ul; row_i < rst.get_ctables()[cv].get_row_labels().size(); ++row_i)
+                classify_row(rst, cv, row_i, dirty);
+
+            if (static_cast<size_t>(cv) + 1 >= level_offsets_.size())
+                continue;
+            for (auto i = level_offsets_[cv]; i < level_offsets_[cv + 1]; ++i) {
+                auto dst = level_order_[i];
+                for (auto j = csr_.in_offsets[dst]; j < csr_.in_offsets[dst + 1]; ++j)
+                    dirty.insert(id(csr_.in_sources[j]));
             }
         }
 
-        // Building transitions
-        auto edges = get_edges_from_rst(no_dup_rst, wc, vertexes, teacher, alphabet);
+        for (const auto &[cv, row_i] : new_rows) {
+            if (not split_tables.contains(cv))
+                classify_row(rst, cv, row_i, dirty);
+        }
+
+        if (grown) {
+            dirty.insert(rst_sync_.below_top.begin(), rst_sync_.below_top.end());
+            rst_sync_.below_top.clear();
+        }
+
+        // Recomputing the edges of affected vertices
+        for (auto src_id : dirty)
+            boost::clear_out_edges(vertex_of(src_id), graph_);
+        for (auto &e : get_edges_from_rst(rst, wc, dirty, teacher, alphabet)) {
+            auto src = vertex_of(name_to_id_.at(std::get<0>(e)));
+            auto dest = vertex_of(name_to_id_.at(std::get<3>(e)));
+            auto new_edge = boost::add_edge(src, dest, bg_edge_attr(std::get<1>(e), std::get<2>(e)), graph_);
+            if (!new_edge.second)
+                throw std::runtime_error("update(): Could not build edge using boost::add_edge.");
+        }
+
+        freeze();
+        V1C2AL_TRACE_ARG("vertices", vertices_n());
+        V1C2AL_TRACE_ARG("dirty", dirty.size());
+    }
+
+    std::optional<behaviour_graph::couples_t>
+    behaviour_graph::find_period(unsigned int level, unsigned int width, alphabet &alphabet) {
+        if (!width)
+            throw std::invalid_argument("find_period(): width cannot be 0.");
+
+        auto subgraph1 = level_range(*this, level, level + width);
+        auto subgraph2 = level_range(*this, level + width, level + 2 * width);
 
-        *this = behaviour_graph(vertexes, edges, "", final_states);
+        return find_isomorphism_(subgraph1, subgraph2, level, level + width, alphabet);
     }
 
-    // Deprecated because result of this is incompatible with to_v1ca and to_r1ca
-    behaviour_graph::new_edges_t
-    behaviour_graph::link_period(behaviour_graph::couples_t &couples) {
-        new_edges_t new_edges;
+    behaviour_graph::level_range::level_range(const behaviour_graph &graph, size_t level_down, size_t level_top)
+            : graph_(graph) {
+        const auto levels_n = graph.level_offsets_.size() - 1;
+        begin_ = graph.level_offsets_[std::min(level_down, levels_n)];
+        end_ = graph.level_offsets_[std::min(level_top + 1, levels_n)];
+        end_ = std::max(begin_, end_);
+    }
 
-        for (const auto &couple : couples) {
-            auto state1 = find_vertex_by_name(couple.first);
-            auto state2 = find_vertex_by_name(couple.second);
-
-            for (auto &edge : get_edges_from_state(state1)) {
-                auto &edge_prop = graph_[edge];
-                if (edge_prop.effect == 1) {
-                    // linking state2 to dest of this edge
-                    auto new_edge = boost::add_edge(state2, boost::target(edge, graph_), edge_prop, graph_);
-                    if (!new_edge.second)
-                        throw std::runtime_error("link_period(): Could not build edge using boost::add_edge.");
-
-                    new_edges.first.emplace_back(new_edge.first.m_source, new_edge.first.m_target);
-                }
-            }
-            for (auto &edge : get_edges_from_state(state2)) {
-                auto &edge_prop = graph_[edge];
-                if (edge_prop.effect == -1) {
-                    // linking state1 to the dest of this edge
-                    auto new_edge = boost::add_edge(state1, boost::target(edge, graph_), edge_prop, graph_);
-                    if (!new_edge.second)
-                        throw std::runtime_error("link_period(): Could not build edge using boost::add_edge.");
-
-                    new_edges.second.emplace_back(new_edge.first.m_source, new_edge.first.m_target);
-                }
-            }
-        }
+    size_t behaviour_graph::level_range::vertices_n() const {
+        return end_ - begin_;
+    }
 
-        return new_edges;
+    behaviour_graph::vertex_descriptor_t behaviour_graph::level_range::vertex(size_t v) const {
+        return graph_.level_order_[begin_ + v];
     }
 
-    void behaviour_graph::delete_high_levels(unsigned int threshold_level) {
-        // Using a weird workaround on property deletion with VecS
-        boost::graph_traits<graph_t>::vertex_iterator v_it, v_it_end, v_it_next;
-        std::tie(v_it, v_it_end) = boost::vertices(graph_);
-        unsigned long graph_size = v_it_end - v_it;
-        for (unsigned long index = graph_size - 1; index < graph_size; --index) {
-            auto vertex = graph_[index];
-            if (vertex.level > static_cast<int>(threshold_level)) {
-                boost::clear_vertex(index, graph_);
-                boost::remove_vertex(index, graph_);
-            }
-        }
+    std::optional<size_t> behaviour_graph::level_range::local(vertex_descriptor_t v) const {
+        auto rank = graph_.level_rank_[v];
+        if (rank < begin_ or rank >= end_)
+            return std::nullopt;
 
-        max_level_ = threshold_level;
+        return rank - begin_;
     }
 
-    behaviour_graph behaviour_graph::get_subgraph(unsigned int level_down, unsigned int level_top) {
-        auto res = behaviour_graph(*this);
+    std::optional<size_t> behaviour_graph::level_range::get_next_vertex(size_t from, char c) const {
+        auto next = graph_.get_next_vertex(vertex(from), c);
+        if (!next)
+            return std::nullopt;
 
-        // Using a weird workaround on property deletion with VecS
-        boost::graph_traits<graph_t>::vertex_iterator v_it, v_it_end;
-        std::tie(v_it, v_it_end) = boost::vertices(res.graph_);
-        unsigned long graph_size = v_it_end - v_it;
-        for (unsigned long index = graph_size - 1; index < graph_size; --index) {
-            auto vertex = res.graph_[index];
-            if (vertex.level < static_cast<int>(level_down) or vertex.level > static_cast<int>(level_top)) {
-                boost::clear_vertex(index, res.graph_);
-                boost::remove_vertex(index, res.graph_);
-            }
+        return local(*next);
+    }
+
+    std::vector<size_t> behaviour_graph::level_range::get_prev_vertices(size_t to, char c) const {
+        std::vector<size_t> res;
+        for (auto prev : graph_.get_prev_vertices(vertex(to), c)) {
+            auto prev_local = local(prev);
+            if (prev_local)
+                res.push_back(*prev_local);
         }
 
         return res;
     }
 
-    std::optional<behaviour_graph::couples_t>
-    behaviour_graph::find_period(unsigned int level, unsigned int width, alphabet &alphabet) {
-        if (!width)
-            throw std::invalid_argument("find_period(): width cannot be 0.");
+    bool behaviour_graph::level_range::is_final(size_t v) const {
+        return graph_.is_final(vertex(v));
+    }
 
-        auto subgraph1 = get_subgraph(level, level + width);
-        auto subgraph2 = get_subgraph(level + width, level + 2 * width);
+    bool behaviour_graph::level_range::is_init(size_t v) const {
+        return graph_.is_init(vertex(v));
+    }
 
-        return subgraph1.is_isomorphic_to(subgraph2, level, level + width, alphabet);
+    size_t behaviour_graph::level_range::level(size_t v) const {
+        return graph_.level(vertex(v));
     }
 
-    std::set<behaviour_graph::edge_descriptor_t>
-    behaviour_graph::get_edges_from_state(behaviour_graph::vertex_descriptor_t state) {
-        std::set<edge_descriptor_t> res;
-        for (auto edge = boost::out_edges(state, graph_); edge.first < edge.second; ++edge.first)
-            res.insert(*edge.first);
+    size_t behaviour_graph::level_range::id(size_t v) const {
+        return graph_.id(vertex(v));
+    }
+
+    const std::string &behaviour_graph::level_range::name(size_t v) const {
+        return graph_.name(vertex(v));
+    }
+
+    /**
+     * Summarize every level of the graph, to discard periods without checking isomorphism
+     * @return The signatures, indexed by level
+     */
+    std::vector<behaviour_graph::level_signature_t> behaviour_graph::get_level_signatures() {
+        auto res = std::vector<level_signature_t>(max_level_ + 1);
+        for (auto v = 0ul; v < vertices_n(); ++v) {
+            auto &signature = res[level(v)];
+            ++signature.vertices;
+            if (is_final(v))
+                ++signature.finals;
+
+            for (auto i = csr_.out_offsets[v]; i < csr_.out_offsets[v + 1]; ++i) {
+                auto target_level = level(csr_.out_targets[i]);
+                auto &histogram = (target_level > level(v)) ? signature.up :
+                                  (target_level == level(v)) ? signature.same : signature.down;
+                ++histogram[csr_.out_symbols[i]];
+            }
+        }
 
         return res;
     }
 
     /**
-     * Recursive implementation of is_isomorphic_to
+     * Look for a period (m, k), i.e. level subgraphs [m, m + k] and [m + k, m + 2k] being isomorphic.
+     * Candidates are ordered by increasing max level m + k of the folded automaton, then by increasing width k,
+     * and the first valid one in this order is returned. Candidates whose level signatures differ are discarded,
+     * and the others are checked by worker threads. A worker stops once a valid candidate was found before the
+     * ones left, so every candidate before the returned one is checked and the result does not depend on
+     * scheduling.
+     * Statistics of the search are kept in period_stats_.
+     * @return The first valid period, std::nullopt if there is none
      */
-    bool behaviour_graph::is_isomorphic_to_(behaviour_graph &other,
-                                            behaviour_graph::states_t &states1,
-                                            behaviour_graph::states_t &states2,
-                                            couples_t &res,
-                                            behaviour_graph::label_map_t &label_map,
-                                            alphabet &alphabet) {
-        if (states1.empty() and states2.empty()) {
+    std::optional<behaviour_graph::period_t> behaviour_graph::search_period(alphabet &alphabet) {
+        V1C2AL_TRACE_SPAN("behaviour_graph::search_period");
+        auto start = std::chrono::steady_clock::now();
+        period_stats_ = period_search_stats();
+
+        auto candidates = std::vector<std::pair<unsigned int, unsigned int>>();
+        for (auto top = 1u; top <= max_level_; ++top) {
+            for (auto k = 1u; k <= top; ++k) {
+                auto m = top - k;
+                if (m + 2 * k <= max_level_)
+                    candidates.emplace_back(m, k);
+            }
+        }
+        period_stats_.candidates = candidates.size();
+
+        // Matching levels of isomorphic level subgraphs have the same signature, except for the edges
+        // leaving the subgraphs (up from their top level and down from their bottom level)
+        const auto signatures = get_level_signatures();
+        const auto may_match = [&signatures](unsigned int m, unsigned int k) {
+            for (auto i = 0u; i <= k; ++i) {
+                const auto &low = signatures[m + i];
+                const auto &high = signatures[m + k + i];
+                if (low.vertices != high.vertices or low.finals != high.finals or low.same != high.same)
+                    return false;
+                if (i < k and low.up != high.up)
+                    return false;
+                if (i > 0 and low.down != high.down)
+                    return false;
+            }
             return true;
+        };
+        std::erase_if(candidates, [&may_match](const auto &candidate) {
+            return not may_match(candidate.first, candidate.second);
+        });
+        period_stats_.pruned = period_stats_.candidates - candidates.size();
+
+        auto results = std::vector<std::optional<couples_t>>(candidates.size());
+        auto next = std::atomic<size_t>(0);
+        auto first_found = std::atomic<size_t>(candidates.size());
+        auto checked = std::atomic<size_t>(0);
+        const auto worker = [&]() {
+            for (auto i = next++; i < candidates.size() and i < first_found.load(); i = next++) {
+                ++checked;
+                results[i] = find_period(candidates[i].first, candidates[i].second, alphabet);
+                if (!results[i])
+                    continue;
+
+                auto current = first_found.load();
+                while (i < current and !first_found.compare_exchange_weak(current, i)) {}
+            }
+        };
+
+        auto threads_n = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), candidates.size());
+        auto threads = std::vector<std::thread>();
+        for (auto t = 1ul; t < threads_n; ++t)
+            threads.emplace_back(worker);
+        worker();
+        for (auto &thread : threads)
+            thread.join();
+
+        period_stats_.checked = checked;
+        period_stats_.threads = std::max<size_t>(threads_n, 1);
+        period_stats_.elapsed_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        V1C2AL_TRACE_ARG("candidates", period_stats_.candidates);
+        V1C2AL_TRACE_ARG("checked", period_stats_.checked);
+
+        if (first_found == candidates.size())
+            return std::nullopt;
+
+        auto chosen = first_found.load();
+        return period_t{candidates[chosen].first, candidates[chosen].second, std::move(*results[chosen])};
+    }
+
+    const behaviour_graph::period_search_stats &behaviour_graph::get_period_search_stats() const {
+        return period_stats_;
+    }
+
+    void behaviour_graph::print_period_search_stats() const {
+        std::cout << "Period search: " << period_stats_.candidates << " candidates, " << period_stats_.pruned
+                  << " pruned by level signatures, " << period_stats_.checked << " checked on "
+                  << period_stats_.threads << " threads in " << period_stats_.elapsed_ms << "ms.\n";
+    }
+
+    /**
+     * Find an isomorphism between two graphs with a color refinement (Weisfeiler-Lehman style).
+     * Vertices of both graphs start with a color made of their init/final flags and of their level relative to the
+     * starting level of their graph. Each round, a vertex gets a new color from its color, the color of its
+     * successor for each symbol and the colors of its predecessors with their symbols, until the partition into
+     * colors stops changing. Colors are shared between both graphs, so isomorphic vertices get the same color,
+     * and the graphs cannot be isomorphic if the numbers of vertices of a color differ. When a color still holds
+     * several vertices, one of them is given a unique color together with each candidate of the other graph in
+     * turn, and refinement starts again.
+     * @param left, right The graphs, each one being a behaviour_graph, a level_range or a v1ca_behaviour_view
+     * @return Couples of ids of matching vertices of the starting levels, std::nullopt if there is no isomorphism
+     */
+    template<class Left, class Right>
+    std::optional<behaviour_graph::couples_t>
+    behaviour_graph::find_isomorphism_(const Left &left, const Right &right, unsigned int from_level1,
+                                       unsigned int from_level2, alphabet &alphabet) {
+        using colors_t = std::vector<size_t>;
+        constexpr auto none = SIZE_MAX;
+
+        const auto n1 = left.vertices_n();
+        const auto n2 = right.vertices_n();
+        if (n1 != n2)
+            return std::nullopt;
+
+        // Neighbours do not change during refinement, so they are looked up once. A vertex has at most one
+        // successor per symbol, but may have several predecessors
+        const auto symbols = std::vector<char>(alphabet.symbols().begin(), alphabet.symbols().end());
+        auto successors1 = std::vector<size_t>();
+        auto successors2 = std::vector<size_t>();
+        auto predecessors1 = std::vector<std::vector<std::pair<long, size_t>>>(n1);
+        auto predecessors2 = std::vector<std::vector<std::pair<long, size_t>>>(n2);
+        for (auto v = 0ul; v < n1; ++v) {
+            for (auto symbol_i = 0ul; symbol_i < symbols.size(); ++symbol_i) {
+                successors1.push_back(left.get_next_vertex(v, symbols[symbol_i]).value_or(none));
+                for (auto prev : left.get_prev_vertices(v, symbols[symbol_i]))
+                    predecessors1[v].emplace_back(symbol_i, prev);
+            }
+        }
+        for (auto v = 0ul; v < n2; ++v) {
+            for (auto symbol_i = 0ul; symbol_i < symbols.size(); ++symbol_i) {
+                successors2.push_back(right.get_next_vertex(v, symbols[symbol_i]).value_or(none));
+                for (auto prev : right.get_prev_vertices(v, symbols[symbol_i]))
+                    predecessors2[v].emplace_back(symbol_i, prev);
+            }
         }
 
-        for (auto state_index1 : states1) {
-            for (auto state_index2 : states2) {
-
-                auto label_map_cp = label_map_t(label_map);
-                if (is_state_isomorphic(other, state_index1, state_index2, label_map_cp, alphabet)) {
-                    // Let's remove the two states from the list (by copy because recursion) and look for other couples
-                    auto new_states1 = states_t(states1);
-                    auto new_states2 = states_t(states2);
-                    new_states1.erase(std::remove(new_states1.begin(), new_states1.end(), state_index1),
-                                      new_states1.end());
-                    new_states2.erase(std::remove(new_states2.begin(), new_states2.end(), state_index2),
-                                      new_states2.end());
-
-                    auto isomorphism_found = is_isomorphic_to_(other, new_states1, new_states2, res, label_map_cp,
-                                                               alphabet);
-                    if (isomorphism_found) {
-                        res.emplace_back(graph_[state_index1].name,
-                                         other.get_mutable_graph()[state_index2].name);
-                    }
+        // Giving the same color to the same signatures across both graphs
+        const auto compress = [](const std::vector<std::vector<long>> &signatures1,
+                                 const std::vector<std::vector<long>> &signatures2,
+                                 colors_t &colors1, colors_t &colors2) {
+            auto ids = std::map<std::vector<long>, size_t>();
+            for (const auto &signature : signatures1)
+                ids.insert({signature, 0});
+            for (const auto &signature : signatures2)
+                ids.insert({signature, 0});
+            auto next_id = 0ul;
+            for (auto &entry : ids)
+                entry.second = next_id++;
+
+            for (auto v = 0ul; v < signatures1.size(); ++v)
+                colors1[v] = ids.at(signatures1[v]);
+            for (auto v = 0ul; v < signatures2.size(); ++v)
+                colors2[v] = ids.at(signatures2[v]);
+
+            return ids.size();
+        };
+
+        const auto refine = [&](colors_t &colors1, colors_t &colors2) {
+            auto classes = std::set<size_t>(colors1.begin(), colors1.end());
+            classes.insert(colors2.begin(), colors2.end());
+            auto classes_n = classes.size();
+
+            const auto signature = [&symbols](const colors_t &colors, const std::vector<size_t> &successors,
+                                              const std::vector<std::vector<std::pair<long, size_t>>> &predecessors,
+                                              size_t v) {
+                auto res = std::vector<long>{static_cast<long>(colors[v])};
+                for (auto i = 0ul; i < symbols.size(); ++i) {
+                    auto next = successors[v * symbols.size() + i];
+                    res.push_back((next == none) ? -1 : static_cast<long>(colors[next]));
+                }
 
-                    // We return either way, because this is the only way to fin isomorphism (no need to keep looking)
-                    return isomorphism_found;
+                // Predecessors are compared as a multiset of (symbol, color)
+                auto prev_colors = std::vector<std::pair<long, long>>();
+                for (const auto &[symbol_i, prev] : predecessors[v])
+                    prev_colors.emplace_back(symbol_i, colors[prev]);
+                std::sort(prev_colors.begin(), prev_colors.end());
+                for (const auto &[symbol_i, color] : prev_colors) {
+                    res.push_back(symbol_i);
+                    res.push_back(color);
                 }
+                return res;
+            };
+
+            while (true) {
+                auto signatures1 = std::vector<std::vector<long>>(n1);
+                auto signatures2 = std::vector<std::vector<long>>(n2);
+                for (auto v = 0ul; v < n1; ++v)
+                    signatures1[v] = signature(colors1, successors1, predecessors1, v);
+                for (auto v = 0ul; v < n2; ++v)
+                    signatures2[v] = signature(colors2, successors2, predecessors2, v);
+
+                // Colors can only be split, so the partition is stable once their number stops growing
+                auto new_classes_n = compress(signatures1, signatures2, colors1, colors2);
+                if (new_classes_n == classes_n)
+                    return;
+                classes_n = new_classes_n;
             }
+        };
+
+        // Initial colors
+        auto colors1 = colors_t(n1);
+        auto colors2 = colors_t(n2);
+        {
+            auto signatures1 = std::vector<std::vector<long>>(n1);
+            auto signatures2 = std::vector<std::vector<long>>(n2);
+            for (auto v = 0ul; v < n1; ++v)
+                signatures1[v] = {left.is_init(v), left.is_final(v), static_cast<long>(left.level(v)) - from_level1};
+            for (auto v = 0ul; v < n2; ++v)
+                signatures2[v] = {right.is_init(v), right.is_final(v),
+                                  static_cast<long>(right.level(v)) - from_level2};
+            compress(signatures1, signatures2, colors1, colors2);
         }
 
-        return false;
+        std::function<std::optional<couples_t>(colors_t, colors_t)> solve;
+        solve = [&](colors_t colors1, colors_t colors2) -> std::optional<couples_t> {
+            refine(colors1, colors2);
+
+            auto histogram1 = std::map<size_t, std::vector<size_t>>();
+            auto histogram2 = std::map<size_t, std::vector<size_t>>();
+            for (auto v = 0ul; v < n1; ++v)
+                histogram1[colors1[v]].push_back(v);
+            for (auto v = 0ul; v < n2; ++v)
+                histogram2[colors2[v]].push_back(v);
+
+            auto ambiguous = histogram1.end();
+            for (auto it = histogram1.begin(); it != histogram1.end(); ++it) {
+                auto found = histogram2.find(it->first);
+                if (found == histogram2.end() or found->second.size() != it->second.size())
+                    return std::nullopt;
+                if (it->second.size() > 1 and ambiguous == histogram1.end())
+                    ambiguous = it;
+            }
+
+            if (ambiguous == histogram1.end()) {
+                // Every color holds a single vertex of each graph, which gives the isomorphism
+                couples_t res;
+                for (auto v = 0ul; v < n1; ++v) {
+                    if (left.level(v) == from_level1)
+                        res.emplace_back(left.id(v), right.id(histogram2.at(colors1[v]).front()));
+                }
+                return res;
+            }
+
+            // Trying every candidate of the other graph for the first vertex of the ambiguous color
+            auto unique_color = histogram1.rbegin()->first + 1;
+            auto v1 = ambiguous->second.front();
+            for (auto v2 : histogram2.at(ambiguous->first)) {
+                auto individualized1 = colors1;
+                auto individualized2 = colors2;
+                individualized1[v1] = unique_color;
+                individualized2[v2] = unique_color;
+
+                auto res = solve(std::move(individualized1), std::move(individualized2));
+                if (res)
+                    return res;
+            }
+
+            return std::nullopt;
+        };
+
+        return solve(std::move(colors1), std::move(colors2));
     }
 
     /**
@@ -342,201 +910,146 @@ namespace active_learning {
     behaviour_graph::is_isomorphic_to(behaviour_graph &other, unsigned int from_level1, unsigned from_level2,
                                       alphabet &alphabet) {
 
-        states_t starting_states_1 = get_all_states_of_level(from_level1);
-        states_t starting_states_2 = other.get_all_states_of_level(from_level2);
-
-        if (starting_states_1.size() != starting_states_2.size()) {
-            return std::nullopt;
-        }
-
-        couples_t res;
-        label_map_t labels;
-        if (is_isomorphic_to_(other, starting_states_1, starting_states_2, res, labels, alphabet)) {
-            return res;
-        }
-
-        return std::nullopt;
+        return find_isomorphism_(*this, other, from_level1, from_level2, alphabet);
     }
 
     /**
-     * Extract all states of a specific level (counter value) of a V1CA.
-     * @param level The level of the states
-     * @return A list of the states
+     * Tell whether this behaviour graph is isomorphic to the one of a V1CA, without building the latter.
+     * @see is_isomorphic_to
      */
-    behaviour_graph::states_t behaviour_graph::get_all_states_of_level(unsigned int level) {
-        states_t res;
-        for (auto vp = boost::vertices(graph_); vp.first != vp.second; ++vp.first) {
-            auto state_index = *vp.first;
-            if (graph_[state_index].level == static_cast<int>(level)) {
-                res.emplace_back(state_index);
-            }
-        }
+    std::optional<behaviour_graph::couples_t>
+    behaviour_graph::is_isomorphic_to(const v1ca_behaviour_view &other, unsigned int from_level1,
+                                      unsigned int from_level2, alphabet &alphabet) {
 
-        return res;
+        return find_isomorphism_(*this, other, from_level1, from_level2, alphabet);
     }
 
-    bool behaviour_graph::is_state_isomorphic(behaviour_graph &other, behaviour_graph::vertex_descriptor_t state1,
-                                              behaviour_graph::vertex_descriptor_t state2,
-                                              behaviour_graph::label_map_t &label_map,
-                                              alphabet &alphabet) {
-        auto queue1 = std::queue<vertex_descriptor_t>();
-        auto queue2 = std::queue<vertex_descriptor_t>();
-        auto visited = std::set<vertex_descriptor_t>();
-
-        // Checking if both states are final, or not, or initial, or not
-        // Using xor to check if values are different
-        if ((is_final(graph_[state1].name) ^ other.is_final(other.graph_[state2].name))
-            or (is_init(graph_[state1].name) ^ other.is_init(other.graph_[state2].name))) {
-            return false;
-        }
-
-        while (!queue1.empty()) {
-            auto q1 = queue1.front();
-            auto q2 = queue2.front();
-            queue1.pop();
-            queue2.pop();
-
-            if (visited.contains(q1))
-                continue;
-            visited.insert(q1);
-
-            // FIXME we could possibly factorize this code
-            for (auto symbol : alphabet.symbols()) {
-                // Checking if same next
-                auto next1 = get_next_vertex(q1, symbol);
-                auto next2 = other.get_next_vertex(q2, symbol);
-
-                if (next1.has_value() ^ next2.has_value())
-                    return false;
-                if (is_init(graph_[*next1].name) ^ other.is_init(other.graph_[*next2].name))
-                    return false;
-                if (is_final(graph_[*next1].name) ^ other.is_final(other.graph_[*next2].name))
-                    return false;
-
-                // Checking label
-                if (!label_map.contains(*next1)) {
-                    if (label_map.contains(*next2))
-                        return false;
-
-                    // Arbitrarily choosing label_map size as label (since we know it was not used before)
-                    auto new_label = label_map.size();
-                    label_map.insert({*next1, new_label});
-                    label_map.insert({*next2, new_label});
-                } else {
-                    if (label_map[*next1] != label_map[*next2])
-                        return false;
-                }
-
-                // Planning to visit next state
-                if (!visited.contains(*next1)) {
-                    queue1.push(*next1);
-                    queue2.push(*next2);
-                }
-
-                // Now checking prev
-                auto prev1 = get_prev_vertex(q1, symbol);
-                auto prev2 = other.get_prev_vertex(q2, symbol);
+    /**
+     * Compare this behaviour graph to a reference V1CA on the words it can describe, i.e. the words whose prefixes
+     * all have a counter value between 0 and the max level of the graph.
+     * This is a breadth-first search over (vertex, reference state, counter value) triples, where missing
+     * transitions lead to a rejecting sink, so the witness is a shortest such word.
+     * @param reference The reference V1CA, seen as a behaviour graph
+     * @return std::nullopt if both agree up to the max level of the graph,
+     *         a shortest word accepted by only one of them otherwise.
+     */
+    std::optional<std::string> behaviour_graph::find_difference_up_to_level(const v1ca_behaviour_view &reference) {
+        using config_t = std::tuple<size_t, size_t, size_t>;
+        constexpr auto sink = SIZE_MAX;
+
+        const auto accepting = [&](const config_t &config) {
+            auto [vertex, ref_state, cv] = config;
+            auto accepted = vertex != sink and is_final(vertex);
+            auto ref_accepted = ref_state != sink and reference.is_final(ref_state);
+            return cv == 0 and accepted != ref_accepted;
+        };
+
+        // Every configuration remembers where it was first reached from
+        auto parents = std::map<config_t, std::pair<config_t, char>>();
+        auto queue = std::queue<config_t>();
+        if (init_vertex_ == csr_t::none)
+            throw std::runtime_error("find_difference_up_to_level(): the behaviour graph has no initial state.");
+        auto init = config_t{init_vertex_, reference.init_state(), 0};
+        parents.insert({init, {init, 0}});
+        queue.push(init);
+
+        while (!queue.empty()) {
+            auto config = queue.front();
+            queue.pop();
+
+            if (accepting(config)) {
+                auto witness = std::string();
+                for (; config != init; config = parents.at(config).first)
+                    witness += parents.at(config).second;
+                std::reverse(witness.begin(), witness.end());
+
+                return witness;
+            }
 
-                if (prev1.has_value() ^ prev1.has_value())
-                    return false;
-                if (is_init(graph_[*prev1].name) ^ other.is_init(other.graph_[*prev2].name))
-                    return false;
-                if (is_final(graph_[*prev1].name) ^ other.is_final(other.graph_[*prev2].name))
-                    return false;
+            auto [vertex, ref_state, cv] = config;
+            for (auto symbol : reference.base().get_alphabet().symbols()) {
+                auto next_cv = static_cast<long>(cv) + reference.effect(symbol);
+                if (next_cv < 0 or next_cv > static_cast<long>(max_level_))
+                    continue;
 
-                // Checking label
-                if (!label_map.contains(*prev1)) {
-                    if (label_map.contains(*prev2))
-                        return false;
-
-                    auto new_label = label_map.size();
-                    label_map.insert({*prev1, new_label});
-                    label_map.insert({*prev2, new_label});
-                } else {
-                    if (label_map[*prev1] != label_map[*prev2])
-                        return false;
-                }
+                auto next_vertex = (vertex == sink) ? std::nullopt : get_next_vertex(vertex, symbol);
+                auto next_ref_state = (ref_state == sink) ? std::nullopt : reference.step(ref_state, symbol, cv);
+                if (!next_vertex and !next_ref_state)
+                    continue;
 
-                // Planning to visit prev
-                if (!visited.contains(*prev1)) {
-                    queue1.push(*prev1);
-                    queue2.push(*prev2);
-                }
+                auto next = config_t{next_vertex.value_or(sink), next_ref_state.value_or(sink),
+                                     static_cast<size_t>(next_cv)};
+                if (parents.insert({next, {config, symbol}}).second)
+                    queue.push(next);
             }
         }
 
-        return true;
+        return std::nullopt;
     }
 
     std::optional<behaviour_graph::vertex_descriptor_t>
-    behaviour_graph::get_next_vertex(vertex_descriptor_t from, char c) {
-        for (auto vp = boost::out_edges(from, graph_); vp.first != vp.second; ++vp.first) {
-            if (graph_[*vp.first].symbol == c) {
-                return boost::target(*vp.first, graph_);
-            }
-        }
+    behaviour_graph::get_next_vertex(vertex_descriptor_t from, char c) const {
+        auto symbol_index = csr_.symbol_index[static_cast<unsigned char>(c)];
+        if (symbol_index < 0 or csr_.next[from * csr_.symbols_n + symbol_index] == csr_t::none)
+            return std::nullopt;
 
-        return std::nullopt;
+        return csr_.next[from * csr_.symbols_n + symbol_index];
     }
 
     std::optional<behaviour_graph::vertex_descriptor_t>
-    behaviour_graph::get_prev_vertex(vertex_descriptor_t to, char c) {
-        for (auto vp = boost::edges(graph_); vp.first != vp.second; ++vp.first) {
-            if (boost::target(*vp.first, graph_) == to and graph_[*vp.first].symbol == c) {
-                return boost::source(*vp.first, graph_);
-            }
-        }
+    behaviour_graph::get_prev_vertex(vertex_descriptor_t to, char c) const {
+        auto symbol_index = csr_.symbol_index[static_cast<unsigned char>(c)];
+        if (symbol_index < 0 or csr_.prev[to * csr_.symbols_n + symbol_index] == csr_t::none)
+            return std::nullopt;
 
-        return std::nullopt;
+        return csr_.prev[to * csr_.symbols_n + symbol_index];
     }
 
-    V1CA::couples_t behaviour_graph::to_v1ca_couple(couples_t couples) {
-        V1CA::couples_t res;
-
-        for (const auto &e: couples) {
-            res.push_back({static_cast<V1CA::state_t>(find_vertex_by_name(e.first)),
-                           static_cast<V1CA::state_t>(find_vertex_by_name(e.second))});
+    std::vector<behaviour_graph::vertex_descriptor_t>
+    behaviour_graph::get_prev_vertices(vertex_descriptor_t to, char c) const {
+        std::vector<vertex_descriptor_t> res;
+        for (auto i = csr_.in_offsets[to]; i < csr_.in_offsets[to + 1]; ++i) {
+            if (csr_.in_symbols[i] == c)
+                res.push_back(csr_.in_sources[i]);
         }
 
         return res;
     }
 
-    std::shared_ptr<V1CA> behaviour_graph::to_v1ca(RST &rst_no_dup, visibly_alphabet_t &alphabet, bool verbose) {
+    std::shared_ptr<V1CA> behaviour_graph::to_v1ca(RST &rst, visibly_alphabet_t &alphabet, bool verbose) {
+        V1C2AL_TRACE_SPAN("behaviour_graph::to_v1ca");
 
-        if (rst_no_dup.size() < 3) {
+        if (rst.size() < 3) {
             if (verbose)
                 std::cout << "Behaviour graph does not have enough levels to find a period.";
             return std::make_shared<V1CA>(to_v1ca_direct(alphabet));
         }
 
-        // m (the potential cv of the period) goes from 0 to max_cv
-        //for (auto m = 0u; m < rst_no_dup.size(); ++m) {
-        for (auto m = 1u; m == 1u; m = 0) {
-            // k (the potential width of the period) goes from ((max_cv - m) / 2) to 1
-            // trying with only 1 for now
-            // for (auto k = (rst_no_dup.size() - m) / 2; k >= 1; --k) {
-            for (auto k = 1u; k == 1u; k = 0) {
-                // Checking if level m and level m+k are isomorphic
-                auto couples = find_period(m, k, alphabet);
-                if (couples.has_value()) {
-                    if (verbose) {
-                        std::cout << "Periodic pattern found between level " << m << " and " << m + k << ".\n";
-                        std::cout << "Couples are: ";
-                        for (const auto &couple : couples.value())
-                            std::cout << '(' << couple.first << ", " << couple.second << ")";
-                        std::cout << "\nMax level is " << m + k << "." << std::endl;
-                    }
-
-                    auto bg_cp = behaviour_graph(*this);
-                    bg_cp.delete_high_levels(m + k);
+        auto period = search_period(alphabet);
+        if (verbose)
+            print_period_search_stats();
+
+        if (period) {
+            auto m = period->m;
+            auto k = period->k;
+            if (verbose) {
+                std::cout << "Periodic pattern found between level " << m << " and " << m + k << ".\n";
+                std::cout << "Couples are: ";
+                for (const auto &couple : period->couples)
+                    std::cout << '(' << name(vertex_of(couple.first)) << ", "
+                              << name(vertex_of(couple.second)) << ")";
+                std::cout << "\nMax level is " << m + k << "." << std::endl;
+            }
 
-                    auto res = bg_cp.to_v1ca_direct(alphabet);
-                    auto v1ca_couples = bg_cp.to_v1ca_couple(couples.value());
-                    res.link_and_color_edges(v1ca_couples);
+            // States of the hypothesis are the vertices of the levels up to m + k
+            auto range = level_range(*this, 0, m + k);
+            auto res = to_v1ca_direct(alphabet, range);
+            auto v1ca_couples = V1CA::couples_t();
+            for (const auto &couple : period->couples)
+                v1ca_couples.push_back({*range.local(vertex_of(couple.first)), *range.local(vertex_of(couple.second))});
+            res.link_and_color_edges(v1ca_couples);
 
-                    return std::make_shared<V1CA>(res);
-                }
-            }
+            return std::make_shared<V1CA>(res);
         }
 
         if (verbose)
@@ -546,107 +1059,68 @@ namespace active_learning {
     }
 
     V1CA behaviour_graph::to_v1ca_direct(visibly_alphabet_t &alphabet) {
-        auto vp = boost::vertices(graph_);
-        auto states = static_cast<size_t>(vp.second - vp.first);
-        auto states_props = std::vector<V1CA::state_prop>(states);
+        return to_v1ca_direct(alphabet, level_range(*this, 0, max_level_));
+    }
 
+    /**
+     * Build a V1CA from the vertices and edges of a level range, whose states are the vertices of the range
+     */
+    V1CA behaviour_graph::to_v1ca_direct(visibly_alphabet_t &alphabet, const level_range &range) {
+        auto states_props = std::vector<V1CA::state_prop>(range.vertices_n());
         auto finals = std::vector<V1CA::state_t>();
 
-        for (; vp.first != vp.second; ++vp.first) {
-            auto prop = graph_[*vp.first];
-            for (auto &name: final_states_) {
-                if (name == prop.name)
-                    finals.emplace_back(static_cast<V1CA::state_t>(*vp.first));
-            }
-            states_props[*vp.first] = {static_cast<size_t>(prop.level), prop.name};
+        for (auto v = 0ul; v < range.vertices_n(); ++v) {
+            if (range.is_final(v))
+                finals.emplace_back(static_cast<V1CA::state_t>(v));
+            states_props[v] = {range.level(v), range.name(v)};
         }
 
         std::cout << "Creating V1CA, adding edges:\n";
         auto transitions = std::vector<std::tuple<size_t, size_t, char>>();
-        for (auto ep = boost::edges(graph_); ep.first != ep.second; ++ep.first) {
-            auto prop = graph_[*ep.first];
-            transitions.emplace_back(std::make_tuple(boost::source(*ep.first, graph_),
-                                                     boost::target(*ep.first, graph_),
-                                                     prop.symbol));
-            std::cout << "(" << boost::source(*ep.first, graph_) << " " << boost::target(*ep.first, graph_) << ") ";
-        }
-        std::cout << '\n';
-
-        return V1CA(states_props, 0lu, finals, alphabet, transitions);
-    }
-
-    R1CA behaviour_graph::to_r1ca_direct(basic_alphabet &alphabet, const behaviour_graph::new_edges_t &new_edges,
-                                         size_t new_edge_lvl) {
-        auto vertices = boost::vertices(graph_);
-        auto states = static_cast<size_t>(vertices.second - vertices.first);
-
-        std::vector<vertex_descriptor_t> finals;
-
-        for (; vertices.first != vertices.second; ++vertices.first) {
-            if (is_final(graph_[*vertices.first].name))
-                finals.emplace_back(*vertices.first);
-        }
-
-        std::vector<std::tuple<size_t, size_t, char, int>> transitions;
-        for (auto ep = boost::edges(graph_); ep.first != ep.second; ++ep.first) {
-            auto edge = *ep.first;
-            auto src = boost::source(edge, graph_);
-            auto dest = boost::target(edge, graph_);
-            auto prop = graph_[edge];
-            transitions.emplace_back(std::make_tuple(src, dest, prop.symbol, prop.effect));
-        }
+        for (auto v = 0ul; v < range.vertices_n(); ++v) {
+            auto src = range.vertex(v);
+            for (auto i = csr_.out_offsets[src]; i < csr_.out_offsets[src + 1]; ++i) {
+                auto dst = range.local(csr_.out_targets[i]);
+                if (!dst)
+                    continue;
 
-        std::map<utils::triple_comp<size_t, size_t, char>, utils::pair_comp<bool, size_t>> colors;
-        for (auto new_e : new_edges.second) {
-            auto src = new_e.first;
-            auto dest = new_e.second;
-            auto symbol = graph_[find_edge(new_e.first, new_e.second)].symbol;
-            colors[{src, dest, symbol}] = {false, new_edge_lvl};
-
-            for (auto &trans: transitions) {
-                auto trans_src = std::get<0>(trans);
-                auto trans_dest = std::get<1>(trans);
-                auto trans_symbol = std::get<2>(trans);
-                if (trans_src == src and trans_symbol == symbol)
-                    colors[{trans_src, trans_dest, trans_symbol}] = {true, new_edge_lvl};
+                transitions.emplace_back(std::make_tuple(v, *dst, csr_.out_symbols[i]));
+                std::cout << "(" << v << " " << *dst << ") ";
             }
         }
+        std::cout << '\n';
 
-        return R1CA(states, max_level_, finals, transitions, colors, alphabet);
+        auto init = (init_vertex_ == csr_t::none) ? std::nullopt : range.local(init_vertex_);
+        return V1CA(states_props, init.value_or(0), finals, alphabet, transitions);
     }
 
-    std::shared_ptr<R1CA> behaviour_graph::to_r1ca(RST &rst_no_dup, basic_alphabet &alphabet, bool verbose) {
-        if (rst_no_dup.size() < 3) {
+    std::shared_ptr<R1CA> behaviour_graph::to_r1ca(RST &rst, basic_alphabet &alphabet, bool verbose) {
+        V1C2AL_TRACE_SPAN("behaviour_graph::to_r1ca");
+        if (rst.size() < 3) {
             if (verbose)
                 std::cout << "Behaviour graph does not have enough levels to find a period.";
             return std::make_shared<R1CA>(to_r1ca_direct(alphabet));
         }
 
-        // m (the potential cv of the period) goes from 0 to max_cv
-        //for (auto m = 0u; m < rst_no_dup.size(); ++m) {
-        for (auto m = 1u; m == 1u; m = 0) {
-            // k (the potential width of the period) goes from ((max_cv - m) / 2) to 1
-            // trying with only 1 for now
-            // for (auto k = (rst_no_dup.size() - m) / 2; k >= 1; --k) {
-            for (auto k = 1u; k == 1u; k = 0) {
-                // Checking if level m and level m+k are isomorphic
-                auto couples = find_period(m, k, alphabet);
-                if (couples.has_value()) {
-                    if (verbose) {
-                        std::cout << "Periodic pattern found between level " << m << " and " << m + k << ".\n";
-                        std::cout << "Couples are: ";
-                        for (const auto &couple : couples.value())
-                            std::cout << '(' << couple.first << ", " << couple.second << ")";
-                        std::cout << "\n";
-                    }
-
-                    auto bg_cp = behaviour_graph(*this);
-                    bg_cp.delete_high_levels(m + k);
-                    auto new_edges = bg_cp.link_period(*couples);
-
-                    return std::make_shared<R1CA>(to_r1ca_direct(alphabet, new_edges, m));
-                }
+        auto period = search_period(alphabet);
+        if (verbose)
+            print_period_search_stats();
+
+        if (period) {
+            auto m = period->m;
+            auto k = period->k;
+            if (verbose) {
+                std::cout << "Periodic pattern found between level " << m << " and " << m + k << ".\n";
+                std::cout << "Couples are: ";
+                for (const auto &couple : period->couples)
+                    std::cout << '(' << name(vertex_of(couple.first)) << ", "
+                              << name(vertex_of(couple.second)) << ")";
+                std::cout << "\n";
             }
+
+            // States of the hypothesis are the vertices of the levels up to m + k
+            return std::make_shared<R1CA>(to_r1ca_direct(alphabet, level_range(*this, 0, m + k), period->couples, m,
+                                                         m + k));
         }
 
         if (verbose)
@@ -656,81 +1130,93 @@ namespace active_learning {
     }
 
     R1CA behaviour_graph::to_r1ca_direct(basic_alphabet &alphabet) {
-        // Creating a finite state automaton, leaving the counter useless
-        auto vertices = boost::vertices(graph_);
-        auto states = static_cast<size_t>(vertices.second - vertices.first);
-
-        std::vector<vertex_descriptor_t> finals;
+        // Creating a finite state automaton, leaving the counter useless: max_level is infinite
+        return to_r1ca_direct(alphabet, level_range(*this, 0, max_level_), {}, 0, UINT64_MAX);
+    }
 
-        for (; vertices.first != vertices.second; ++vertices.first) {
-            if (is_final(graph_[*vertices.first].name))
-                finals.emplace_back(*vertices.first);
+    /**
+     * Build a R1CA from the vertices and edges of a level range, whose states are the vertices of the range.
+     * A period between the levels m and m + k, the top of the range, is closed on the states of each couple (q, q'):
+     *   - q' gets the edges of q going up, as the range has no level above m + k,
+     *   - q gets the edges of q' going down, taken when the counter is above m, its own being taken up to m.
+     * @param range The levels whose vertices are the states
+     * @param couples The couples of vertex ids of the period (see period_t), empty if there is no period
+     * @param period_level The level m of the period
+     * @param max_level Counter values above it use the transitions of max_level
+     */
+    R1CA behaviour_graph::to_r1ca_direct(basic_alphabet &alphabet, const level_range &range, const couples_t &couples,
+                                         size_t period_level, size_t max_level) {
+        auto finals = std::vector<size_t>();
+        auto transitions = std::vector<std::tuple<size_t, size_t, char, int>>();
+        for (auto v = 0ul; v < range.vertices_n(); ++v) {
+            if (range.is_final(v))
+                finals.emplace_back(v);
+
+            for (auto [it, end] = boost::out_edges(range.vertex(v), graph_); it != end; ++it) {
+                auto dst = range.local(boost::target(*it, graph_));
+                if (dst)
+                    transitions.emplace_back(v, *dst, graph_[*it].symbol, graph_[*it].effect);
+            }
         }
 
-        std::vector<std::tuple<size_t, size_t, char, int>> transitions;
-        for (auto ep = boost::edges(graph_); ep.first != ep.second; ++ep.first) {
-            auto edge = *ep.first;
-            auto src = boost::source(edge, graph_);
-            auto dest = boost::target(edge, graph_);
-            auto prop = graph_[edge];
-            transitions.emplace_back(std::make_tuple(src, dest, prop.symbol, prop.effect));
+        auto linked = std::vector<std::tuple<size_t, size_t, char, int>>();
+        for (const auto &couple : couples) {
+            auto bottom = *range.local(vertex_of(couple.first));
+            auto top = *range.local(vertex_of(couple.second));
+            for (const auto &[src, dst, symbol, effect] : transitions) {
+                if (src == bottom and effect == 1)
+                    linked.emplace_back(top, dst, symbol, effect);
+                else if (src == top and effect == -1)
+                    linked.emplace_back(bottom, dst, symbol, effect);
+            }
         }
 
         std::map<utils::triple_comp<size_t, size_t, char>, utils::pair_comp<bool, size_t>> colors;
-        // max_lvl is infinite cause we do not use the counter
-        return R1CA(states, UINT64_MAX, finals, transitions, colors, alphabet);
-    }
+        for (const auto &[src, dst, symbol, effect] : linked) {
+            // Same target as an edge of the range, which is then taken at every counter value
+            auto existing = std::find_if(transitions.begin(), transitions.end(), [&](const auto &trans) {
+                return std::get<0>(trans) == src and std::get<1>(trans) == dst and std::get<2>(trans) == symbol;
+            });
+            if (existing != transitions.end())
+                continue;
 
-    behaviour_graph::edge_descriptor_t
-    behaviour_graph::find_edge(behaviour_graph::vertex_descriptor_t src, behaviour_graph::vertex_descriptor_t dst) {
-        for (auto edges = boost::edges(graph_); edges.first != edges.second; ++edges.first) {
-            auto ed = *edges.first;
-            if (boost::target(ed, graph_) == dst and boost::source(ed, graph_) == src)
-                return ed;
+            if (effect == -1) {
+                for (const auto &[trans_src, trans_dst, trans_symbol, trans_effect] : transitions) {
+                    if (trans_src == src and trans_symbol == symbol)
+                        colors[{trans_src, trans_dst, trans_symbol}] = {true, period_level};
+                }
+                colors[{src, dst, symbol}] = {false, period_level};
+            }
+            transitions.emplace_back(src, dst, symbol, effect);
         }
 
-        throw std::invalid_argument("No edge found for given vertex descriptors");
+        auto init = (init_vertex_ == csr_t::none) ? std::nullopt : range.local(init_vertex_);
+        return R1CA(range.vertices_n(), max_level, finals, transitions, colors, alphabet, init.value_or(0));
     }
 
+    /**
+     * Build the behaviour graph of a V1CA, as presented by a v1ca_behaviour_view.
+     * Prefer using the view directly when the graph is only read.
+     */
     behaviour_graph behaviour_graph::from_v1ca(const V1CA &v1ca) {
-        auto behaviour_v1ca = V1CA(v1ca);
-
-        // Removing loop-ins
-        for (auto state = 0u; state < behaviour_v1ca.states_n_; ++state) {
-            if (behaviour_v1ca.state_props_.at(state).level == behaviour_v1ca.max_level_) {
-                auto out_trans = behaviour_v1ca.get_out_trans(state);
-                for (auto trans: out_trans) {
-                    if (behaviour_v1ca.alphabet_.get_cv(trans.first.symbol) > 0) {
-                        behaviour_v1ca.transitions_.erase(trans.first);
-                    }
-                }
-            }
-        }
+        auto view = v1ca_behaviour_view(v1ca);
 
         auto vertexes = vertexes_t();
-        for (auto i = 0u; i < behaviour_v1ca.states_n_; ++i) {
-            auto prop = behaviour_v1ca.state_props_.at(i);
-            vertexes.emplace_back(prop.name, prop.level);
-        }
-
-        auto edges = edges_t();
-        for (auto trans : behaviour_v1ca.transitions_) {
-            const auto &from = behaviour_v1ca.state_props_.at(trans.first.state).name;
-            const auto &to = behaviour_v1ca.state_props_.at(trans.second.state).name;
-            const auto &symbol = trans.first.symbol;
-            const auto &effect = behaviour_v1ca.alphabet_.get_cv(symbol);
-
-            edges.emplace_back(from, symbol, effect, to);
-        }
-
         auto finals = std::set<std::string>();
-        for (auto final : behaviour_v1ca.final_states_) {
-            finals.insert(behaviour_v1ca.state_props_.at(final).name);
+        auto edges = edges_t();
+        for (auto state = 0u; state < view.states_n(); ++state) {
+            vertexes.emplace_back(view.name(state), view.level(state));
+            if (view.is_final(state))
+                finals.insert(view.name(state));
+
+            for (auto symbol : v1ca.alphabet_.symbols()) {
+                auto next = view.get_next_vertex(state, symbol);
+                if (next)
+                    edges.emplace_back(view.name(state), symbol, view.effect(symbol), view.name(*next));
+            }
         }
 
-        auto init = behaviour_v1ca.state_props_.at(behaviour_v1ca.init_state_).name;
-
-        return behaviour_graph(vertexes, edges, init, finals);
+        return behaviour_graph(vertexes, edges, view.name(view.init_state()), finals);
     }
 
 }
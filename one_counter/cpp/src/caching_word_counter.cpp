@@ -0,0 +1,106 @@
+#include "caching_word_counter.h"
+
+namespace active_learning {
+
+    /**
+     * @param counter The counter to be decorated, which must outlive the cache
+     */
+    caching_word_counter::caching_word_counter(const word_counter &counter) : counter_(counter), trie_(1) {
+        // The root of the trie is the empty word
+        trie_[0].cv = 0;
+    }
+
+    int caching_word_counter::get_cv(const std::string &word) const {
+        auto node = 0ul;
+        for (auto c : word) {
+            auto child = trie_[node].children.find(c);
+            if (child == trie_[node].children.end()) {
+                ++misses_;
+                return memoize(word).back();
+            }
+            node = child->second;
+        }
+
+        ++hits_;
+        return trie_[node].cv;
+    }
+
+    /**
+     * Get the counter value of a one symbol word, without building a string when it is cached
+     */
+    int caching_word_counter::get_cv(char symbol) const {
+        auto index = static_cast<unsigned char>(symbol);
+        if (symbol_known_[index]) {
+            ++hits_;
+            return symbol_cv_[index];
+        }
+
+        symbol_cv_[index] = get_cv(std::string(1, symbol));
+        symbol_known_[index] = true;
+        return symbol_cv_[index];
+    }
+
+    std::vector<int> caching_word_counter::get_prefixes_cv(const std::string &word) const {
+        auto res = std::vector<int>();
+        res.reserve(word.size() + 1);
+        res.push_back(trie_[0].cv);
+
+        auto node = 0ul;
+        for (auto c : word) {
+            auto child = trie_[node].children.find(c);
+            if (child == trie_[node].children.end()) {
+                ++misses_;
+                return memoize(word);
+            }
+            node = child->second;
+            res.push_back(trie_[node].cv);
+        }
+
+        ++hits_;
+        return res;
+    }
+
+    /**
+     * Count every prefix of a word with the decorated counter, and add the missing ones to the trie
+     * @return The counter value of every prefix of the word, as get_prefixes_cv()
+     */
+    std::vector<int> caching_word_counter::memoize(const std::string &word) const {
+        auto prefixes_cv = counter_.get_prefixes_cv(word);
+
+        auto node = 0ul;
+        for (auto i = 0u; i < word.size(); ++i) {
+            auto child = trie_[node].children.find(word[i]);
+            if (child != trie_[node].children.end()) {
+                node = child->second;
+                continue;
+            }
+
+            // Not using a reference on trie_[node] as the push_back may move it
+            auto new_node = trie_.size();
+            trie_.push_back({prefixes_cv[i + 1], {}});
+            trie_[node].children.insert({word[i], new_node});
+            node = new_node;
+        }
+
+        return prefixes_cv;
+    }
+
+    size_t caching_word_counter::hits() const {
+        return hits_;
+    }
+
+    size_t caching_word_counter::misses() const {
+        return misses_;
+    }
+
+    double caching_word_counter::hit_rate() const {
+        auto queries = hits_ + misses_;
+        return queries ? static_cast<double>(hits_) / static_cast<double>(queries) : 0.;
+    }
+
+    std::string caching_word_counter::sum_up_msg() const {
+        return "Counter cache: " + std::to_string(hits_) + " hits, " + std::to_string(misses_) + " misses ("
+               + std::to_string(static_cast<int>(hit_rate() * 100)) + "% hit rate), "
+               + std::to_string(trie_.size()) + " words memoized.";
+    }
+}
@@ -1,4 +1,5 @@
 #include "dataframe.h"
+#include "trace.h"
 
 #include <iostream>
 
@@ -170,6 +171,7 @@ namespace active_learning {
     void RST::expand_RST(int cv) {
         while (cv >= static_cast<int>(tables_.size())) {
             tables_.emplace_back();
+            journal_.push_back({change::kind::table, static_cast<int>(tables_.size() - 1), 0});
         }
     }
 
@@ -179,8 +181,9 @@ namespace active_learning {
      * @return A copy of the RST with possibly rows removed. The original RST is not changed.
      */
     RST RST::remove_duplicate_rows() const {
+        V1C2AL_TRACE_SPAN("RST::remove_duplicate_rows");
         // Creating copy (not in place)
-        RST res = RST(*this);
+        RST res = copy_tables();
 
         for (auto &table : res.get_tables()) {
             for (auto row_i = 0u; row_i < table.get_data().size(); ++row_i) {
@@ -193,10 +196,26 @@ namespace active_learning {
                 }
             }
         }
+        res.rebuild_journal();
 
         return res;
     }
 
+    /**
+     * Replace the journal by one creating the current tables from scratch, for RSTs whose rows were removed
+     */
+    void RST::rebuild_journal() {
+        journal_.clear();
+        journal_begin_ = 0;
+        for (auto cv = 0; cv < static_cast<int>(tables_.size()); ++cv) {
+            journal_.push_back({change::kind::table, cv, 0});
+            for (auto i = 0ul; i < tables_[cv].get_col_labels().size(); ++i)
+                journal_.push_back({change::kind::col, cv, i});
+            for (auto i = 0ul; i < tables_[cv].get_row_labels().size(); ++i)
+                journal_.push_back({change::kind::row, cv, i});
+        }
+    }
+
     /**
      * Add a new row at the right table. Row is filled with false values
      * @param name The name of the new row
@@ -206,6 +225,7 @@ namespace active_learning {
     void RST::add_row(const std::string &name, int cv) {
         expand_RST(cv);
         tables_[cv].add_row(name);
+        journal_.push_back({change::kind::row, cv, tables_[cv].get_row_labels().size() - 1});
     }
 
     /**
@@ -218,6 +238,7 @@ namespace active_learning {
     void RST::add_row_using_query(const std::string &name, int cv, teacher &teacher) {
         expand_RST(cv);
         tables_[cv].add_row_using_query(name, teacher);
+        journal_.push_back({change::kind::row, cv, tables_[cv].get_row_labels().size() - 1});
     }
 
     /**
@@ -229,6 +250,7 @@ namespace active_learning {
     void RST::add_col(const std::string &name, int cv) {
         expand_RST(cv);
         tables_[cv].add_col(name);
+        journal_.push_back({change::kind::col, cv, tables_[cv].get_col_labels().size() - 1});
     }
 
     /**
@@ -241,6 +263,7 @@ namespace active_learning {
     void RST::add_col_using_query(const std::string &name, int cv, teacher &teacher) {
         expand_RST(cv);
         tables_[cv].add_col_using_query(name, teacher);
+        journal_.push_back({change::kind::col, cv, tables_[cv].get_col_labels().size() - 1});
     }
 
     /**
@@ -248,8 +271,7 @@ namespace active_learning {
      * @param teacher The teacher used for the membership query
      */
     RST::RST(teacher &teacher) {
-        tables_.emplace_back();
-        tables_[0].add_col("");
+        add_col("", 0);
         add_row_using_query("", 0, teacher, "rst init");
     }
 
@@ -269,6 +291,49 @@ namespace active_learning {
         return tables_;
     }
 
+    /**
+     * Copy the tables of the RST, without the journal, for copies whose changes are not followed by a behaviour graph.
+     * The journal of the copy starts where the one of the RST ends.
+     * @return A RST with the same tables and an empty journal
+     */
+    RST RST::copy_tables() const {
+        auto res = RST();
+        res.tables_ = tables_;
+        res.journal_begin_ = journal_begin_ + journal_.size();
+
+        return res;
+    }
+
+    /**
+     * Class getter
+     * @return The changes made to the RST that were not trimmed yet, the first one being at the position
+     * journal_begin()
+     */
+    const std::vector<RST::change> &RST::get_journal() const {
+        return journal_;
+    }
+
+    /**
+     * Class getter
+     * @return The position of the first change of get_journal(), i.e. the number of changes trimmed so far
+     */
+    size_t RST::journal_begin() const {
+        return journal_begin_;
+    }
+
+    /**
+     * Drop the changes of the journal before a position, once they were applied
+     * @param pos The position of the first change to keep, counted from the creation of the RST
+     */
+    void RST::trim_journal(size_t pos) {
+        if (pos <= journal_begin_)
+            return;
+
+        auto trimmed = std::min(pos - journal_begin_, journal_.size());
+        journal_.erase(journal_.begin(), journal_.begin() + static_cast<long>(trimmed));
+        journal_begin_ += trimmed;
+    }
+
     /**
      * Compares the boolean values of two rows of a RST from the same table.
      * @param word1 The label of the first row
@@ -311,6 +376,75 @@ namespace active_learning {
         return tables_.size();
     }
 
+    /**
+     * @return The number of rows of all tables
+     */
+    size_t RST::rows_n() const {
+        auto res = 0ul;
+        for (const auto &table : tables_)
+            res += table.get_row_labels().size();
+
+        return res;
+    }
+
+    /**
+     * @return The number of columns of all tables
+     */
+    size_t RST::cols_n() const {
+        auto res = 0ul;
+        for (const auto &table : tables_)
+            res += table.get_col_labels().size();
+
+        return res;
+    }
+
+    /**
+     * @return The number of cells of all tables
+     */
+    size_t RST::cells_n() const {
+        auto res = 0ul;
+        for (const auto &table : tables_) {
+            for (const auto &row : table.get_cdata())
+                res += row.size();
+        }
+
+        return res;
+    }
+
+    /**
+     * @return The memory held by the cells of all tables, rows being bit vectors
+     */
+    size_t RST::cells_bytes() const {
+        auto res = 0ul;
+        for (const auto &table : tables_) {
+            res += table.get_cdata().capacity() * sizeof(std::vector<bool>);
+            for (const auto &row : table.get_cdata())
+                res += (row.capacity() + 7) / 8;
+        }
+
+        return res;
+    }
+
+    /**
+     * @return The memory held by the row and column labels of all tables, short labels living in their string
+     */
+    size_t RST::labels_bytes() const {
+        const auto bytes = [](const std::vector<std::string> &labels) {
+            auto res = labels.capacity() * sizeof(std::string);
+            for (const auto &label : labels) {
+                if (label.capacity() >= sizeof(std::string))
+                    res += label.capacity() + 1;
+            }
+            return res;
+        };
+
+        auto res = 0ul;
+        for (const auto &table : tables_)
+            res += bytes(table.get_row_labels()) + bytes(table.get_col_labels());
+
+        return res;
+    }
+
     /**
      * Add a counter example to the RST.
      * For each prefix of the counter example (including the counter example itself), adds it as a new row label
@@ -322,9 +456,15 @@ namespace active_learning {
      * @param wc The object used to process counter value
      */
     void RST::add_counter_example(const std::string &ce, teacher &teacher, word_counter &wc) {
-        for (const auto &word : get_all_prefixes(ce)) {
-
-            int cv = wc.get_cv(word);
+        V1C2AL_TRACE_SPAN("RST::add_counter_example");
+        V1C2AL_TRACE_ARG("length", ce.size());
+        // Counter values of all prefixes are computed at once, in the same order as get_all_prefixes()
+        auto prefixes_cv = wc.get_prefixes_cv(ce);
+        auto prefixes = get_all_prefixes(ce);
+        for (auto prefix_i = 0u; prefix_i < prefixes.size(); ++prefix_i) {
+            const auto &word = prefixes[prefix_i];
+
+            int cv = prefixes_cv[prefix_i];
             expand_RST(cv);
             auto &table = tables_[cv];
 
@@ -1,12 +1,91 @@
 #include "dot_writers.h"
 
-void active_learning::writer::write_v1ca(std::ostream &out, active_learning::V1CA &automaton) {
+#include <stdexcept>
+
+namespace {
+
+    // Edge of a DOT export, standing for every guard of a (state, symbol) leading to the same target
+    template<class Target>
+    struct merged_edge {
+        Target target;
+        std::string ranges;
+    };
+
+    /**
+     * Merge the guards of a (state, symbol) by target, after cutting them to a window.
+     * Guards are sorted, so ranges are listed in increasing order.
+     * @return The edges, in the order of the first guard of each target
+     */
+    template<class Guards>
+    auto merge_guards(const Guards &guards, const active_learning::dot_window &window, size_t max_level) {
+        using target_t = decltype(guards.front().target);
+        auto res = std::vector<merged_edge<target_t>>();
+        for (const auto &guard : guards) {
+            auto lo = std::max(guard.lo, window.level_down);
+            auto hi = std::min(guard.hi, window.level_top);
+            if (lo > hi)
+                continue;
+
+            auto label = utils::guard_label(lo, hi, max_level);
+            auto edge = std::find_if(res.begin(), res.end(), [&guard](const auto &e) {
+                return e.target == guard.target;
+            });
+            if (edge == res.end())
+                res.push_back({guard.target, label});
+            else
+                edge->ranges += "," + label;
+        }
+
+        return res;
+    }
+}
+
+/**
+ * @param path The file the text is streamed to
+ * @throws runtime_error if the file cannot be opened
+ */
+active_learning::dot_buffer::dot_buffer(const std::string &path) {
+    file_.open(path, std::ios::binary);
+    if (!file_.is_open())
+        throw std::runtime_error("dot_buffer(): Could not open '" + path + "'.");
+    buffer_.reserve(2 * flush_size);
+}
+
+active_learning::dot_buffer::~dot_buffer() {
+    if (file_.is_open())
+        flush();
+}
+
+/**
+ * Write the buffered text to the file, if the buffer streams to one
+ */
+void active_learning::dot_buffer::flush() {
+    if (!file_.is_open())
+        return;
+
+    file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+}
+
+/**
+ * Write a V1CA as DOT, with a single edge for all the guards of a (state, symbol) going to the same target
+ * with the same color, labelled with their counter ranges
+ */
+void active_learning::writer::write_v1ca(active_learning::dot_buffer &out, active_learning::V1CA &automaton,
+                                         const active_learning::dot_window &window) {
+    const auto in_window = [&automaton, &window](size_t state) {
+        auto level = automaton.state_props_[state].level;
+        return window.level_down <= level and level <= window.level_top;
+    };
 
     out << "Digraph G {\n";
 
     // Printing states
-    for (auto st=0ul; st < automaton.states_n_; ++st) {
-        auto prop = automaton.state_props_[st];
+    for (auto st = 0ul; st < automaton.states_n_; ++st) {
+        if (!in_window(st))
+            continue;
+
+        const auto &prop = automaton.state_props_[st];
         out << st
             << "[label=\""
             << prop.level
@@ -17,66 +96,107 @@ void active_learning::writer::write_v1ca(std::ostream &out, active_learning::V1C
             << "\"];\n";
     }
 
-    // Printing transitions
-    for (auto trans : automaton.transitions_) {
+    // Printing transitions, one per target and color
+    for (const auto &[key, guards] : automaton.transitions_) {
+        if (!in_window(key.first))
+            continue;
 
         auto sign = "";
-        auto symbol_cv = automaton.alphabet_.get_cv(trans.first.symbol);
+        auto symbol_cv = automaton.alphabet_.get_cv(key.second);
         if (symbol_cv < 0)
             sign = "-";
         else if (symbol_cv > 0)
             sign = "+";
 
-        // Matching color with loop type
-        auto color = (trans.second.color == V1CA::transition_color::loop_in_bottom) ? "red" :
-                     (trans.second.color == V1CA::transition_color::loop_in_top) ? "gold4" :
-                     (trans.second.color == V1CA::transition_color::loop_out) ? "blue" :
-                     "black";
+        for (const auto &edge : merge_guards(guards, window, automaton.max_level_)) {
+            if (!in_window(edge.target.state))
+                continue;
 
-        out << trans.first.state
-            << "->"
-            << trans.second.state
-            << " [label=\""
-            << sign
-            << trans.first.symbol
-            << " "
-            << trans.first.counter
-            << "\", color=\""
-            << color
-            << "\"];\n";
+            // Matching color with loop type
+            auto color = (edge.target.color == V1CA::transition_color::loop_in_bottom) ? "red" :
+                         (edge.target.color == V1CA::transition_color::loop_in_top) ? "gold4" :
+                         (edge.target.color == V1CA::transition_color::loop_out) ? "blue" :
+                         "black";
+
+            out << key.first
+                << "->"
+                << edge.target.state
+                << " [label=\""
+                << sign
+                << key.second
+                << " "
+                << edge.ranges
+                << "\", color=\""
+                << color
+                << "\"];\n";
+        }
     }
 
     out << "}\n";
 }
 
-active_learning::vertex_writer::vertex_writer(active_learning::displayable &display_obj) : to_display_(display_obj) {}
-
-void active_learning::vertex_writer::write_behaviour_graph(std::ostream &out,
-                                                           const active_learning::behaviour_graph::vertex_descriptor_t &v) {
-    auto &bg = dynamic_cast<behaviour_graph &>(to_display_);
-    auto &g = bg.get_mutable_graph();
-    const auto prop = g[v];
-    auto final = bg.is_final(prop.name);
-    std::string name = prop.name;
-    if (prop.name.empty())
-        name = "_";
-    out << "[label=\"" << prop.level << " " << prop.name << "\", shape=\""
-        << ((final) ? "doublecircle" : "circle") << "\"]";
+/**
+ * Write a R1CA as DOT, with a single edge for all the guards of a (state, symbol) going to the same target
+ * with the same effect, labelled with their counter ranges
+ */
+void active_learning::writer::write_r1ca(active_learning::dot_buffer &out, active_learning::R1CA &automaton,
+                                         const active_learning::dot_window &window) {
+    // Writing states
+    out << "digraph G {\n";
+    for (auto i = 0u; i < automaton.states_n_; ++i) {
+        out << i << "[ shape=\""
+            << ((automaton.is_final(i)) ? "doublecircle" : "circle")
+            << "\"];\n";
+    }
+    for (auto &[key, guards] : automaton.transitions_) {
+        for (const auto &edge : merge_guards(guards, window, automaton.max_level_)) {
+            out << key.first
+                << "->"
+                << edge.target.state
+                << " [label=\""
+                << key.second
+                << " "
+                << edge.ranges
+                << "\"];\n";
+        }
+    }
+    out << "}\n";
 }
 
-void active_learning::edge_writer::write_behaviour_graph(std::ostream &out,
-                                                         const active_learning::behaviour_graph::edge_descriptor_t &e) {
-
-    auto &bg = dynamic_cast<behaviour_graph &>(to_display_);
+void active_learning::writer::write_behaviour_graph(active_learning::dot_buffer &out,
+                                                    active_learning::behaviour_graph &bg) {
     auto &graph = bg.get_mutable_graph();
 
-    const auto prop = graph[e];
-    out << "[label=\"";
+    out << "digraph G {\n";
 
-    if (prop.effect == -1)
-        out << "-";
-    else if (prop.effect == 1)
-        out << "+";
+    // Printing vertices
+    for (auto v = 0ul; v < bg.vertices_n(); ++v) {
+        const auto &prop = graph[v];
+        out << v
+            << "[label=\""
+            << prop.level
+            << " "
+            << prop.name
+            << "\", shape=\""
+            << ((bg.is_final(v)) ? "doublecircle" : "circle")
+            << "\"];\n";
+    }
+
+    // Printing edges
+    for (auto ep = boost::edges(graph); ep.first != ep.second; ++ep.first) {
+        const auto &prop = graph[*ep.first];
+        out << boost::source(*ep.first, graph)
+            << "->"
+            << boost::target(*ep.first, graph)
+            << " [label=\"";
 
-    out << prop.symbol << R"(", color="black"])";
+        if (prop.effect == -1)
+            out << "-";
+        else if (prop.effect == 1)
+            out << "+";
+
+        out << prop.symbol << R"(", color="black"];)" << '\n';
+    }
+
+    out << "}\n";
 }
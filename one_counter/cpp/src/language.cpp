@@ -27,11 +27,23 @@ namespace active_learning {
         if (cv_w != wc.get_cv(word2))
             return false;
 
-        auto rst_copy = RST(rst);
-        rst_copy.add_row_using_query_if_not_present(word1, cv_w, teacher, "is_O_equivalent");
-        rst_copy.add_row_using_query_if_not_present(word2, cv_w, teacher, "is_O_equivalent");
+        return is_O_equivalent(word1, word2, cv_w, rst, teacher);
+    }
+
+    /**
+     * Same as is_O_equivalent, for two words already known to have the counter value cv.
+     * This saves counting the words again, which costs a simulation of the reference for R1CA.
+     */
+    bool is_O_equivalent(const std::string &word1, const std::string &word2, int cv, RST &rst, teacher &teacher) {
+        if (word1 == word2)
+            return true;
 
-        return rst_copy.compare_rows(word1, word2, cv_w);
+        // Rows are only added to compare them, the journal does not need to follow
+        auto rst_copy = rst.copy_tables();
+        rst_copy.add_row_using_query_if_not_present(word1, cv, teacher, "is_O_equivalent");
+        rst_copy.add_row_using_query_if_not_present(word2, cv, teacher, "is_O_equivalent");
+
+        return rst_copy.compare_rows(word1, word2, cv);
     }
 
     /**
@@ -50,11 +62,14 @@ namespace active_learning {
         }
 
         auto res = std::set<std::string>();
-        for (auto &table : rst.get_tables()) {
-            for (auto &label : table.get_row_labels()) {
-                if (is_O_equivalent(word, label, rst, wc, teacher)) {
-                    res.insert(label);
-                }
+        if (cv_w < 0 or cv_w >= static_cast<int>(rst.size()))
+            return res;
+
+        // Rows of the other tables have a different cv, so they cannot be O_equivalent to word,
+        // and the ones of this table are known to have the cv of word
+        for (auto &label : rst.get_tables()[cv_w].get_row_labels()) {
+            if (is_O_equivalent(word, label, cv_w, rst, teacher)) {
+                res.insert(label);
             }
         }
 
@@ -2,12 +2,33 @@
 #include "dataframe.h"
 #include "behaviour_graph.h"
 #include "language.h"
+#include "trace.h"
+#include "allocation_tracker.h"
 
 #include <iostream>
 #include <teachers/automaton_teacher.h>
 
 namespace active_learning {
 
+    namespace {
+        // Footprint of the structures of the learner at the end of a round, for the allocation tracker
+        void add_round_footprint(size_t round, const RST &rst, const behaviour_graph &bg, const teacher &teacher) {
+            if (!allocation_tracker::is_enabled())
+                return;
+
+            auto stats = allocation_tracker::round_stats();
+            stats.round = round;
+            stats.rst_tables = rst.size();
+            stats.rst_cells = rst.cells_n();
+            stats.rst_cell_bytes = rst.cells_bytes();
+            stats.rst_label_bytes = rst.labels_bytes();
+            stats.queries = teacher.get_membership_queries_n();
+            stats.graph_vertices = bg.vertices_n();
+            stats.graph_edges = bg.edges_n();
+            allocation_tracker::get_default().add_round(stats);
+        }
+    }
+
     learner::learner(teacher &teacher, alphabet &alphabet) : teacher_(teacher), alphabet_(alphabet) {
         as_visibly_alphabet_ = dynamic_cast<visibly_alphabet_t*>(&alphabet);
         as_basic_alphabet_ = dynamic_cast<basic_alphabet_t*>(&alphabet);
@@ -21,20 +42,24 @@ namespace active_learning {
      * @return true if the RST was already consistent, false if a change was made
      */
     bool learner::make_rst_consistent(RST &rst) {
-        for (auto &table : rst.get_tables()) {
+        V1C2AL_TRACE_SPAN("learner::make_rst_consistent");
+        for (auto table_cv = 0u; table_cv < rst.size(); ++table_cv) {
+            auto &table = rst.get_tables()[table_cv];
             for (auto u_i = 0u; u_i < table.get_row_labels().size(); ++u_i) {
                 const std::string &u = table.get_row_labels()[u_i];
                 for (auto v_i = u_i + 1; v_i < table.get_row_labels().size(); ++v_i) {
                     const std::string &v = table.get_row_labels()[v_i];
-                    if (is_O_equivalent_(u, v, rst)) {
+                    // Rows of a table share its cv, so it does not need to be counted again
+                    if (is_O_equivalent(u, v, static_cast<int>(table_cv), rst, teacher_)) {
                         for (auto c : alphabet_.symbols()) {
                             std::string uc = u + c;
                             std::string vc = v + c;
                             auto cv_uc = get_cv(uc);
-                            if (cv_uc < 0) {
+                            // Words above the top table of the RST are out of its context
+                            if (cv_uc < 0 or cv_uc >= static_cast<int>(rst.size())) {
                                 continue;
                             }
-                            if (!is_O_equivalent_(uc, vc, rst)) {
+                            if (get_cv(vc) != cv_uc or !is_O_equivalent(uc, vc, cv_uc, rst, teacher_)) {
                                 if (cv_uc > static_cast<int>(rst.size())) {
                                     throw std::runtime_error("make_rst_consistent(): Unexpected cv which is out of bound of rst was encountered.");
                                 }
@@ -64,6 +89,7 @@ namespace active_learning {
      * @return true if the RST was already closed, false if a change was made
      */
     bool learner::make_rst_closed(RST &rst) {
+        V1C2AL_TRACE_SPAN("learner::make_rst_closed");
         for (size_t i = 0; i < rst.size(); ++i) {
             auto &table = rst.get_tables()[i];
             for (const std::string& u: table.get_row_labels()) {
@@ -115,17 +141,26 @@ namespace active_learning {
      */
     V1CA learner::learn_V1CA(bool verbose)
     {
+        V1C2AL_TRACE_SPAN("learner::learn_V1CA");
         mode_ = learner_mode::V1CA;
         if (!as_visibly_alphabet_)
             throw std::invalid_argument("Learning a V1CA requires a visibly type of alphabet.");
+        counter_ = std::make_unique<caching_word_counter>(*as_visibly_alphabet_);
 
         // Initialising rst with "" and "" as only labels for rows and columns
+        stats_ = learning_stats();
         auto rst = RST(teacher_);
         std::shared_ptr<V1CA> res = nullptr;
+        // Kept between rounds, to only recompute what changed in the RST
+        auto bg = behaviour_graph();
 
         // Looping until V1CA is accepted by teacher
         auto v1ca_correct = false;
+        auto round = 0ul;
         while (!v1ca_correct) {
+            V1C2AL_TRACE_SPAN("learner::round");
+            ++round;
+            V1C2AL_TRACE_ARG("round", round);
 
             auto is_consistent = false;
             auto is_closed = false;
@@ -142,42 +177,62 @@ namespace active_learning {
                 }
             }
 
-            // Removing duplicates inside RST (to avoid state duplication)
-            RST rst_no_dup = rst.remove_duplicate_rows();
-            // Creating behaviour graph
-            auto bg = behaviour_graph(rst_no_dup, *as_visibly_alphabet_, teacher_, alphabet_);
+            // Applying the changes made to the RST since the last round, duplicated rows sharing a vertex
+            bg.update(rst, *counter_, teacher_, alphabet_);
 
             // Testing partial equivalence on behaviour graph
             auto partial_eq = teacher_.partial_equivalence_query(bg, "behaviour_graph");
             if (!partial_eq) {
                 // Making V1CA by (maybe) finding a periodic subgraph
-                res = bg.to_v1ca(rst_no_dup, *as_visibly_alphabet_, verbose);
+                res = bg.to_v1ca(rst, *as_visibly_alphabet_, verbose);
+                // Merging the equivalent states left by the folding, so the teacher checks a smaller hypothesis
+                res = std::make_shared<V1CA>(res->minimize());
                 // Testing V1CA equivalence
                 auto eq = teacher_.equivalence_query(*res, "v1ca");
                 if (!eq)
                     v1ca_correct = true;
                 else
-                    rst.add_counter_example(*eq, teacher_, *as_visibly_alphabet_);
+                    rst.add_counter_example(*eq, teacher_, *counter_);
             } else {
-                rst.add_counter_example(*partial_eq, teacher_, *as_visibly_alphabet_);
+                rst.add_counter_example(*partial_eq, teacher_, *counter_);
             }
+
+            V1C2AL_TRACE_ARG("rst_tables", rst.size());
+            V1C2AL_TRACE_ARG("rst_rows", rst.rows_n());
+            V1C2AL_TRACE_ARG("rst_cols", rst.cols_n());
+            V1C2AL_TRACE_ARG("queries", teacher_.get_membership_queries_n());
+            end_round(round, rst, bg);
         }
 
+        if (verbose)
+            std::cout << counter_->sum_up_msg() << std::endl;
+
         return *res;
     }
 
     R1CA learner::learn_R1CA(bool verbose) {
+        V1C2AL_TRACE_SPAN("learner::learn_R1CA");
         if (!as_basic_alphabet_)
             throw std::invalid_argument("Learning a R1CA requires a basic type of alphabet.");
+        if (!as_automaton_teacher_)
+            throw std::invalid_argument("Learning a R1CA requires an automaton teacher to count words.");
 
         mode_ = learner_mode::R1CA;
+        counter_ = std::make_unique<caching_word_counter>(*as_automaton_teacher_);
         // Initialising rst with "" and "" as only labels for rows and columns
+        stats_ = learning_stats();
         auto rst = RST(teacher_);
         std::shared_ptr<R1CA> res = nullptr;
+        // Kept between rounds, to only recompute what changed in the RST
+        auto bg = behaviour_graph();
 
         // Looping until V1CA is accepted by teacher
         auto v1ca_correct = false;
+        auto round = 0ul;
         while (!v1ca_correct) {
+            V1C2AL_TRACE_SPAN("learner::round");
+            ++round;
+            V1C2AL_TRACE_ARG("round", round);
 
             auto is_consistent = false;
             auto is_closed = false;
@@ -194,71 +249,72 @@ namespace active_learning {
                 }
             }
 
-            // Removing duplicates inside RST (to avoid state duplication)
-            RST rst_no_dup = rst.remove_duplicate_rows();
-            // Creating behaviour graph
-            auto bg = behaviour_graph(rst_no_dup, *as_automaton_teacher_, teacher_, alphabet_);
+            // Applying the changes made to the RST since the last round, duplicated rows sharing a vertex
+            bg.update(rst, *counter_, teacher_, alphabet_);
 
             // Testing partial equivalence on behaviour graph
             auto partial_eq = teacher_.partial_equivalence_query(bg, "behaviour_graph");
             if (!partial_eq) {
                 // Making V1CA by (maybe) finding a periodic subgraph
-                res = bg.to_r1ca(rst_no_dup, *as_basic_alphabet_, verbose);
+                res = bg.to_r1ca(rst, *as_basic_alphabet_, verbose);
                 // Testing V1CA equivalence
                 auto eq = teacher_.equivalence_query(*res, "v1ca");
                 if (!eq)
                     v1ca_correct = true;
                 else
-                    rst.add_counter_example(*eq, teacher_, *as_automaton_teacher_);
+                    rst.add_counter_example(*eq, teacher_, *counter_);
             } else {
-                rst.add_counter_example(*partial_eq, teacher_, *as_automaton_teacher_);
+                rst.add_counter_example(*partial_eq, teacher_, *counter_);
             }
+
+            V1C2AL_TRACE_ARG("rst_tables", rst.size());
+            V1C2AL_TRACE_ARG("rst_rows", rst.rows_n());
+            V1C2AL_TRACE_ARG("rst_cols", rst.cols_n());
+            V1C2AL_TRACE_ARG("queries", teacher_.get_membership_queries_n());
+            end_round(round, rst, bg);
         }
 
+        if (verbose)
+            std::cout << counter_->sum_up_msg() << std::endl;
+
         return *res;
     }
 
 
-    int learner::get_cv(const std::string &word) {
-        if (mode_ == learner_mode::V1CA)
-            return as_visibly_alphabet_->get_cv(word);
-        else if (mode_ == learner_mode::R1CA)
-            return dynamic_cast<automaton_teacher&>(teacher_).count_query(word);
+    /**
+     * Record the size of the learning at the end of a round
+     */
+    void learner::end_round(size_t round, const RST &rst, const behaviour_graph &bg) {
+        stats_.rounds = round;
+        stats_.rst_tables = rst.size();
+        stats_.rst_rows = rst.rows_n();
+        stats_.rst_cols = rst.cols_n();
+        add_round_footprint(round, rst, bg, teacher_);
+    }
 
-        throw std::runtime_error("Unknown learner_type while processing cv");
+    const learning_stats &learner::get_stats() const {
+        return stats_;
     }
 
-    int learner::get_cv(char symbol) {
-        if (mode_ == learner_mode::V1CA) {
-            return as_visibly_alphabet_->get_cv(symbol);
-        } else if (mode_ == learner_mode::R1CA) {
-            auto symbol_as_str = std::string() + symbol;
-            return dynamic_cast<automaton_teacher&>(teacher_).count_query(symbol_as_str);
-        }
+    int learner::get_cv(const std::string &word) {
+        if (!counter_)
+            throw std::runtime_error("Unknown learner_type while processing cv");
 
-        throw std::runtime_error("Unknown learner_type while processing cv");
+        return counter_->get_cv(word);
     }
 
-    std::set<std::string> learner::get_congruence_set_(const std::string &word, RST &rst) {
-
-        if (mode_ == learner_mode::V1CA) {
-            return get_congruence_set(word, rst, *as_visibly_alphabet_, teacher_);
-        } else if (mode_ == learner_mode::R1CA) {
-            return get_congruence_set(word, rst, dynamic_cast<automaton_teacher&>(teacher_), teacher_);
-        }
+    int learner::get_cv(char symbol) {
+        if (!counter_)
+            throw std::runtime_error("Unknown learner_type while processing cv");
 
-        throw std::runtime_error("Unknown learner_type while processing congruence set");
+        return counter_->get_cv(symbol);
     }
 
-    bool learner::is_O_equivalent_(const std::string &word1, const std::string &word2, RST &rst) {
-
-        if (mode_ == learner_mode::V1CA) {
-            return is_O_equivalent(word1, word2, rst, *as_visibly_alphabet_, teacher_);
-        } else if (mode_ == learner_mode::R1CA) {
-            return is_O_equivalent(word1, word2, rst, dynamic_cast<automaton_teacher&>(teacher_), teacher_);
-        }
+    std::set<std::string> learner::get_congruence_set_(const std::string &word, RST &rst) {
+        if (!counter_)
+            throw std::runtime_error("Unknown learner_type while processing congruence set");
 
-        throw std::runtime_error("Unknown learner_type while processing O_equivalent");
+        return get_congruence_set(word, rst, *counter_, teacher_);
     }
 
 }
@@ -0,0 +1,159 @@
+#include "lifted_v1ca.h"
+
+#include <stack>
+#include <stdexcept>
+
+namespace active_learning {
+
+    /**
+     * @param automaton The V1CA to be lifted, which must outlive the view
+     * @param max_level The max level of the view, at least the one of the V1CA
+     * @throws invalid_argument if max_level is lower than the max level of the V1CA
+     */
+    lifted_v1ca::lifted_v1ca(const V1CA &automaton, size_t max_level) : automaton_(automaton), max_level_(max_level) {
+        if (max_level < automaton.max_level_)
+            throw std::invalid_argument("A V1CA can only be lifted to a higher max level.");
+    }
+
+    size_t lifted_v1ca::max_level() const {
+        return max_level_;
+    }
+
+    lifted_v1ca::state_t lifted_v1ca::init_state() const {
+        return automaton_.init_state_;
+    }
+
+    size_t lifted_v1ca::states_bound() const {
+        return automaton_.states_n_ * (max_level_ - automaton_.max_level_ + 1);
+    }
+
+    bool lifted_v1ca::is_final(state_t state) const {
+        return automaton_.final_states_.contains(state % automaton_.states_n_);
+    }
+
+    size_t lifted_v1ca::level(state_t state) const {
+        return automaton_.state_props_.at(state % automaton_.states_n_).level + state / automaton_.states_n_;
+    }
+
+    std::string lifted_v1ca::name(state_t state) const {
+        const auto &base_name = automaton_.state_props_.at(state % automaton_.states_n_).name;
+        auto offset = state / automaton_.states_n_;
+
+        return (offset == 0) ? base_name : base_name + "_" + std::to_string(offset);
+    }
+
+    const V1CA &lifted_v1ca::base() const {
+        return automaton_;
+    }
+
+    bool lifted_v1ca::is_top(state_t base_state) const {
+        return automaton_.state_props_.at(base_state).level >= automaton_.max_level_;
+    }
+
+    /**
+     * Get the lifted state corresponding to a state of the V1CA reached with a given counter value
+     */
+    lifted_v1ca::state_t lifted_v1ca::lift(state_t base_state, size_t cv) const {
+        if (not is_top(base_state))
+            return base_state;
+
+        auto offset = std::min(std::max(cv, automaton_.max_level_), max_level_) - automaton_.max_level_;
+        return base_state + offset * automaton_.states_n_;
+    }
+
+    /**
+     * Compute the guards of a lifted state for a symbol. A lifted state of level m + j (j > 0) is reached with a
+     * counter value of m + j in the lifted view, but with any higher one in the materialized V1CA, whose counter
+     * is clipped to M: it keeps the transitions of every value from m + j up, repeating the per-value targets of
+     * the other copies. As levels are not always tied to counter values, the lifted states of level m keep the
+     * transitions of every value. The target of a transition going to the max level of the V1CA depends on the
+     * counter value it is taken with, until this value gets above M.
+     * @param state The lifted state
+     * @param symbol The symbol read
+     * @return The sorted guards, whose targets are lifted states
+     */
+    std::vector<lifted_v1ca::guard_t> lifted_v1ca::guards(state_t state, char symbol) const {
+        const auto base_max_level = automaton_.max_level_;
+        const auto base_state = state % automaton_.states_n_;
+        const auto offset = state / automaton_.states_n_;
+
+        const auto *all_guards = automaton_.transitions_.guards(base_state, symbol);
+        if (not all_guards)
+            return {};
+
+        // Lowest counter value the lifted state can be reached with. Higher ones are kept too: once materialized,
+        // the counter is clipped to M when looking transitions up, so a word climbing above M comes down through
+        // copies of lower levels with a counter still at M or more.
+        const auto lo_cv = (is_top(base_state) and offset > 0) ? base_max_level + offset : 0ul;
+        const auto hi_cv = V1CA::transition_func_t::unbounded;
+
+        auto res = std::vector<guard_t>();
+        const auto push = [&res](size_t lo, size_t hi, const V1CA::transition_y &target) {
+            if (not res.empty() and res.back().hi + 1 == lo and res.back().target == target)
+                res.back().hi = hi;
+            else
+                res.push_back({lo, hi, target});
+        };
+
+        const auto effect = static_cast<long>(automaton_.alphabet_.get_cv(symbol));
+        for (const auto &guard : V1CA::effective_guards(*all_guards, base_max_level)) {
+            auto lo = std::max(guard.lo, lo_cv);
+            auto hi = std::min(guard.hi, hi_cv);
+            if (lo > hi)
+                continue;
+
+            if (not is_top(guard.target.state)) {
+                push(lo, hi, guard.target);
+                continue;
+            }
+
+            auto cv = lo;
+            for (; cv <= hi and static_cast<long>(cv) + effect < static_cast<long>(max_level_); ++cv) {
+                auto next_cv = std::max(0l, static_cast<long>(cv) + effect);
+                push(cv, cv, {lift(guard.target.state, next_cv), guard.target.color});
+            }
+            if (cv <= hi)
+                push(cv, hi, {lift(guard.target.state, max_level_), guard.target.color});
+        }
+
+        return res;
+    }
+
+    /**
+     * Materialize the reachable part of the view as a V1CA
+     */
+    V1CA lifted_v1ca::to_v1ca() const {
+        auto res = V1CA(automaton_.alphabet_);
+        res.max_level_ = max_level_;
+
+        auto ids = std::map<state_t, state_t>();
+        auto stack = std::stack<state_t>();
+        const auto get_id = [&](state_t state) {
+            auto found = ids.find(state);
+            if (found != ids.end())
+                return found->second;
+
+            auto id = res.add_state({level(state), name(state)});
+            if (is_final(state))
+                res.final_states_.insert(id);
+            ids.insert({state, id});
+            stack.push(state);
+            return id;
+        };
+        res.init_state_ = get_id(init_state());
+
+        while (not stack.empty()) {
+            auto state = stack.top();
+            stack.pop();
+            auto src = ids.at(state);
+
+            for (auto symbol : automaton_.alphabet_.symbols()) {
+                for (const auto &guard : guards(state, symbol))
+                    res.transitions_.assign(src, symbol, guard.lo, guard.hi,
+                                            {get_id(guard.target.state), guard.target.color});
+            }
+        }
+
+        return res;
+    }
+}
@@ -3,6 +3,8 @@
 #include <teachers/automaton_teacher.h>
 #include "language.h"
 #include "learner.h"
+#include "model_file.h"
+#include "trace.h"
 
 /**
  * @return true if the word is in the language {a^n.b^n}
@@ -57,11 +59,11 @@ bool is_xanybnz(const std::string &word) {
 active_learning::R1CA get_anbam_ref(active_learning::basic_alphabet &alphabet) {
     std::set<size_t> final = {1};
     auto transitions = active_learning::R1CA::transition_func_t();
-    transitions.insert(std::make_pair<active_learning::R1CA::transition_x, active_learning::R1CA::transition_y>({0, 0, 'a'}, {0, 1}));
-    transitions.insert(std::make_pair<active_learning::R1CA::transition_x, active_learning::R1CA::transition_y>({0, 1, 'a'}, {0, 1}));
-    transitions.insert(std::make_pair<active_learning::R1CA::transition_x, active_learning::R1CA::transition_y>({0, 1, 'b'}, {1, 0}));
-    transitions.insert(std::make_pair<active_learning::R1CA::transition_x, active_learning::R1CA::transition_y>({1, 0, 'a'}, {1, 0}));
-    transitions.insert(std::make_pair<active_learning::R1CA::transition_x, active_learning::R1CA::transition_y>({1, 1, 'a'}, {1, -1}));
+    transitions.assign(0, 'a', 0, 0, {0, 1});
+    transitions.assign(0, 'a', 1, 1, {0, 1});
+    transitions.assign(0, 'b', 1, 1, {1, 0});
+    transitions.assign(1, 'a', 0, 0, {1, 0});
+    transitions.assign(1, 'a', 1, 1, {1, -1});
 
     return active_learning::R1CA::from_scratch(0, 2, 0, final, transitions, alphabet);
 }
@@ -79,6 +81,7 @@ void learn_v1ca(bool verbose) {
     std::cout << teacher.sum_up_msg() << std::endl;
 
     res.display("res");
+    active_learning::write_model(res, "res.model");
 }
 
 void learn_r1ca(bool verbose) {
@@ -93,10 +96,20 @@ void learn_r1ca(bool verbose) {
     std::cout << teacher.sum_up_msg() << std::endl;
 
     res.display("res");
+    active_learning::write_model(res, "res.model");
 }
 
 int main() {
+#ifdef V1C2AL_TRACE
+    active_learning::tracer::get_default().start(active_learning::trace_output::chrome_json, "v1c2al_trace.json");
+#endif
     learn_v1ca(true);
+#ifdef V1C2AL_TRACE
+    active_learning::tracer::get_default().stop();
+#endif
+#ifdef V1C2AL_ALLOC_TRACKING
+    active_learning::allocation_tracker::get_default().write_summary("v1c2al_allocations.json");
+#endif
 
     return 0;
 }
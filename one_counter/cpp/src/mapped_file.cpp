@@ -0,0 +1,73 @@
+#include "mapped_file.h"
+
+#include <utility>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace active_learning {
+
+    /**
+     * Map a file in memory, read-only
+     * @param path The path to the file
+     * @throws runtime_error if the file cannot be opened or mapped
+     */
+    mapped_file::mapped_file(const std::string &path) {
+        auto fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Could not open file '" + path + "'.");
+
+        struct stat file_stat{};
+        if (fstat(fd, &file_stat) < 0) {
+            close(fd);
+            throw std::runtime_error("Could not get the size of file '" + path + "'.");
+        }
+
+        size_ = static_cast<size_t>(file_stat.st_size);
+        if (size_ > 0) {
+            auto *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Could not map file '" + path + "' in memory.");
+            }
+            data_ = static_cast<const char *>(addr);
+        }
+
+        // The mapping stays valid once the file descriptor is closed
+        close(fd);
+    }
+
+    mapped_file::mapped_file(mapped_file &&other) noexcept
+            : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    mapped_file &mapped_file::operator=(mapped_file &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+
+        return *this;
+    }
+
+    mapped_file::~mapped_file() {
+        unmap();
+    }
+
+    const char *mapped_file::data() const {
+        return data_;
+    }
+
+    size_t mapped_file::size() const {
+        return size_;
+    }
+
+    void mapped_file::unmap() {
+        if (data_)
+            munmap(const_cast<char *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
@@ -0,0 +1,369 @@
+#include "model_file.h"
+
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace active_learning {
+
+    static uint64_t align_8(uint64_t offset) {
+        return (offset + 7) & ~uint64_t(7);
+    }
+
+    /**
+     * Build the header of a model file, sections offsets excepted
+     * @throws invalid_argument if the automaton is too large to fit in the format
+     */
+    static model_header make_header(model_kind kind, const std::set<char> &symbols, size_t states_n,
+                                    size_t init_state, size_t max_level, size_t finals_n) {
+        if (states_n >= model_no_state or max_level >= model_no_state)
+            throw std::invalid_argument("Automaton is too large to be written as a binary model.");
+
+        auto header = model_header();
+        std::memcpy(header.magic, model_magic, sizeof(model_magic));
+        header.version = model_version;
+        header.kind = kind;
+        header.symbols_n = static_cast<uint32_t>(symbols.size());
+        header.states_n = static_cast<uint32_t>(states_n);
+        header.init_state = static_cast<uint32_t>(init_state);
+        header.max_level = static_cast<uint32_t>(max_level);
+        header.finals_n = static_cast<uint32_t>(finals_n);
+
+        std::fill(std::begin(header.symbol_index), std::end(header.symbol_index), model_no_symbol);
+        auto i = 0u;
+        for (auto symbol : symbols) {
+            header.symbols[i] = symbol;
+            header.symbol_index[static_cast<unsigned char>(symbol)] = static_cast<uint8_t>(i);
+            ++i;
+        }
+
+        return header;
+    }
+
+    static uint64_t table_size(const model_header &header) {
+        return uint64_t(header.states_n) * (uint64_t(header.max_level) + 1) * header.symbols_n;
+    }
+
+    static uint64_t table_index(const model_header &header, size_t state, size_t cv, uint8_t symbol_index) {
+        return (uint64_t(state) * (uint64_t(header.max_level) + 1) + cv) * header.symbols_n + symbol_index;
+    }
+
+    /**
+     * Compute the offsets of every section and write the whole model file
+     */
+    static void write_sections(const std::string &path, model_header &header, const std::vector<uint32_t> &levels,
+                               const std::vector<std::string> &names, const std::vector<uint32_t> &finals,
+                               const std::vector<model_transition> &table) {
+        auto name_offsets = std::vector<uint32_t>({0});
+        for (const auto &name : names)
+            name_offsets.emplace_back(static_cast<uint32_t>(name_offsets.back() + name.size()));
+
+        auto offset = align_8(sizeof(model_header));
+        const auto place = [&offset](uint64_t bytes) {
+            auto at = offset;
+            offset = align_8(offset + bytes);
+            return at;
+        };
+        header.levels_offset = place(levels.size() * sizeof(uint32_t));
+        header.name_offsets_offset = place(name_offsets.size() * sizeof(uint32_t));
+        header.names_offset = place(name_offsets.back());
+        header.finals_offset = place(finals.size() * sizeof(uint32_t));
+        header.table_offset = place(table.size() * sizeof(model_transition));
+        header.file_size = offset;
+
+        auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+        if (not out.is_open())
+            throw std::runtime_error("Could not open file '" + path + "'.");
+
+        const auto write_at = [&out](uint64_t at, const void *data, uint64_t bytes) {
+            static const char zeros[8] = {};
+            auto pos = static_cast<uint64_t>(out.tellp());
+            out.write(zeros, static_cast<std::streamsize>(at - pos));
+            out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        };
+        write_at(0, &header, sizeof(header));
+        write_at(header.levels_offset, levels.data(), levels.size() * sizeof(uint32_t));
+        write_at(header.name_offsets_offset, name_offsets.data(), name_offsets.size() * sizeof(uint32_t));
+        out.seekp(static_cast<std::streamoff>(header.names_offset));
+        for (const auto &name : names)
+            out.write(name.data(), static_cast<std::streamsize>(name.size()));
+        write_at(header.finals_offset, finals.data(), finals.size() * sizeof(uint32_t));
+        write_at(header.table_offset, table.data(), table.size() * sizeof(model_transition));
+        write_at(header.file_size, nullptr, 0);
+
+        if (not out)
+            throw std::runtime_error("Could not write model to file '" + path + "'.");
+    }
+
+    /**
+     * Write a V1CA to a binary model file, with its state levels and names, and its transitions as a dense table
+     * @param automaton The V1CA, typically a learned hypothesis
+     * @param path The path to the model file
+     */
+    void write_model(const V1CA &automaton, const std::string &path) {
+        const auto &symbols = automaton.alphabet_.symbols();
+        auto header = make_header(model_kind::v1ca, symbols, automaton.states_n_, automaton.init_state_,
+                                  automaton.max_level_, automaton.final_states_.size());
+        for (auto i = 0u; i < header.symbols_n; ++i)
+            header.effects[i] = automaton.alphabet_.get_cv(header.symbols[i]);
+
+        auto levels = std::vector<uint32_t>(automaton.states_n_, 0);
+        auto names = std::vector<std::string>(automaton.states_n_);
+        for (const auto &[state, prop] : automaton.state_props_) {
+            if (state < automaton.states_n_) {
+                levels[state] = static_cast<uint32_t>(prop.level);
+                names[state] = prop.name;
+            }
+        }
+
+        auto finals = std::vector<uint32_t>(automaton.final_states_.begin(), automaton.final_states_.end());
+
+        auto table = std::vector<model_transition>(table_size(header), {model_no_state, 0});
+        for (const auto &[key, guards] : automaton.transitions_) {
+            auto symbol_index = header.symbol_index[static_cast<unsigned char>(key.second)];
+            for (const auto &guard : guards) {
+                for (auto cv = guard.lo; cv <= std::min<size_t>(guard.hi, header.max_level); ++cv) {
+                    table[table_index(header, key.first, cv, symbol_index)] =
+                            {static_cast<uint32_t>(guard.target.state), static_cast<int32_t>(guard.target.color)};
+                }
+            }
+        }
+
+        write_sections(path, header, levels, names, finals, table);
+    }
+
+    /**
+     * Write a R1CA to a binary model file, with its transitions (and their counter effect) as a dense table
+     * @param automaton The R1CA, typically a learned hypothesis
+     * @param path The path to the model file
+     */
+    void write_model(const R1CA &automaton, const std::string &path) {
+        // Above the highest guard bound transitions no longer depend on the counter, which gives a finite table
+        // for R1CA that never clip their counter
+        auto max_level = 0ul;
+        for (const auto &[key, guards] : automaton.transitions_) {
+            for (const auto &guard : guards)
+                max_level = std::max({max_level, guard.lo, (guard.hi == R1CA::transition_func_t::unbounded) ? 0 : guard.hi + 1});
+        }
+        max_level = std::min(max_level, automaton.max_level_);
+
+        auto header = make_header(model_kind::r1ca, automaton.alphabet_.symbols(), automaton.states_n_,
+                                  automaton.init_state_, max_level, automaton.final_states_.size());
+
+        auto levels = std::vector<uint32_t>(automaton.states_n_, 0);
+        auto names = std::vector<std::string>(automaton.states_n_);
+        auto finals = std::vector<uint32_t>(automaton.final_states_.begin(), automaton.final_states_.end());
+
+        auto table = std::vector<model_transition>(table_size(header), {model_no_state, 0});
+        for (const auto &[key, guards] : automaton.transitions_) {
+            auto symbol_index = header.symbol_index[static_cast<unsigned char>(key.second)];
+            for (const auto &guard : guards) {
+                for (auto cv = guard.lo; cv <= std::min<size_t>(guard.hi, header.max_level); ++cv) {
+                    table[table_index(header, key.first, cv, symbol_index)] =
+                            {static_cast<uint32_t>(guard.target.state), guard.target.effect};
+                }
+            }
+        }
+
+        write_sections(path, header, levels, names, finals, table);
+    }
+
+    /**
+     * Get a section of the mapped file
+     * @param offset The offset of the section in the file
+     * @param count The number of elements of the section
+     * @throws runtime_error if the section does not fit in the file or is misaligned
+     */
+    template<class T>
+    const T *model_view::section(uint64_t offset, uint64_t count) const {
+        if (offset % alignof(T) != 0 or offset > file_.size()
+            or count > (file_.size() - offset) / sizeof(T))
+            throw std::runtime_error("Invalid model file: section out of bounds.");
+
+        return reinterpret_cast<const T *>(file_.data() + offset);
+    }
+
+    /**
+     * Map a binary model file and check its structure. Nothing is copied or parsed.
+     * @param path The path to the model file
+     * @throws runtime_error if the file cannot be mapped or is not a valid model file
+     */
+    model_view::model_view(const std::string &path) : file_(path) {
+        if (file_.size() < sizeof(model_header))
+            throw std::runtime_error("Invalid model file '" + path + "': too short.");
+
+        header_ = reinterpret_cast<const model_header *>(file_.data());
+        if (std::memcmp(header_->magic, model_magic, sizeof(model_magic)) != 0)
+            throw std::runtime_error("Invalid model file '" + path + "': bad magic number.");
+        if (header_->version != model_version)
+            throw std::runtime_error("Unsupported model file version " + std::to_string(header_->version) + ".");
+        if (header_->kind != model_kind::v1ca and header_->kind != model_kind::r1ca)
+            throw std::runtime_error("Invalid model file '" + path + "': unknown automaton kind.");
+        if (header_->file_size != file_.size() or header_->symbols_n > 256
+            or header_->max_level >= model_no_state
+            or (header_->states_n > 0 and header_->init_state >= header_->states_n))
+            throw std::runtime_error("Invalid model file '" + path + "': inconsistent header.");
+
+        for (auto c = 0u; c < 256; ++c) {
+            auto index = header_->symbol_index[c];
+            if (index != model_no_symbol
+                and (index >= header_->symbols_n or static_cast<unsigned char>(header_->symbols[index]) != c))
+                throw std::runtime_error("Invalid model file '" + path + "': inconsistent symbols.");
+        }
+
+        levels_ = section<uint32_t>(header_->levels_offset, header_->states_n);
+        name_offsets_ = section<uint32_t>(header_->name_offsets_offset, uint64_t(header_->states_n) + 1);
+        names_ = section<char>(header_->names_offset, name_offsets_[header_->states_n]);
+        finals_ = section<uint32_t>(header_->finals_offset, header_->finals_n);
+        table_ = section<model_transition>(header_->table_offset, table_size(*header_));
+
+        for (auto i = 0u; i < header_->states_n; ++i) {
+            if (name_offsets_[i] > name_offsets_[i + 1])
+                throw std::runtime_error("Invalid model file '" + path + "': inconsistent state names.");
+        }
+        if (not std::is_sorted(finals_, finals_ + header_->finals_n)
+            or (header_->finals_n > 0 and finals_[header_->finals_n - 1] >= header_->states_n))
+            throw std::runtime_error("Invalid model file '" + path + "': inconsistent final states.");
+    }
+
+    model_kind model_view::kind() const {
+        return header_->kind;
+    }
+
+    size_t model_view::states_n() const {
+        return header_->states_n;
+    }
+
+    size_t model_view::max_level() const {
+        return header_->max_level;
+    }
+
+    size_t model_view::init_state() const {
+        return header_->init_state;
+    }
+
+    size_t model_view::level(size_t state) const {
+        return levels_[state];
+    }
+
+    std::string_view model_view::name(size_t state) const {
+        return {names_ + name_offsets_[state], name_offsets_[state + 1] - name_offsets_[state]};
+    }
+
+    bool model_view::is_final(size_t state) const {
+        return std::binary_search(finals_, finals_ + header_->finals_n, state);
+    }
+
+    /**
+     * Read a transition in the dense table. The counter value is clipped to the max level.
+     * @return The transition, nullptr if there is none
+     * @throws runtime_error if the transition leads to a state that does not exist
+     */
+    const model_transition *model_view::step(size_t state, size_t cv, char symbol) const {
+        auto index = header_->symbol_index[static_cast<unsigned char>(symbol)];
+        if (index == model_no_symbol or state >= header_->states_n)
+            return nullptr;
+
+        const auto *trans = &table_[table_index(*header_, state, std::min<size_t>(cv, header_->max_level), index)];
+        if (trans->state == model_no_state)
+            return nullptr;
+        if (trans->state >= header_->states_n)
+            throw std::runtime_error("Invalid model file: transition to an unknown state.");
+
+        return trans;
+    }
+
+    /**
+     * Run a word on the mapped automaton, directly on the transition table
+     * @return true if the word is accepted, i.e. it ends in a final state with a counter value of 0
+     */
+    bool model_view::accepts(const std::string &word) const {
+        auto state = static_cast<size_t>(header_->init_state);
+        long cv = 0;
+
+        for (char c : word) {
+            const auto *trans = step(state, static_cast<size_t>(cv), c);
+            if (not trans)
+                return false;
+
+            state = trans->state;
+            cv += (header_->kind == model_kind::v1ca)
+                  ? header_->effects[header_->symbol_index[static_cast<unsigned char>(c)]]
+                  : trans->data;
+            if (cv < 0)
+                return false;
+        }
+
+        return header_->states_n > 0 and is_final(state) and cv == 0;
+    }
+
+    /**
+     * Build the V1CA stored in the mapped file
+     * @param alphabet The alphabet of the V1CA, which must be the one it was written with
+     * @throws runtime_error if the file does not contain a V1CA
+     * @throws invalid_argument if the alphabet is not the one of the file
+     */
+    V1CA model_view::to_v1ca(const visibly_alphabet_t &alphabet) const {
+        if (header_->kind != model_kind::v1ca)
+            throw std::runtime_error("Model file does not contain a V1CA.");
+        if (alphabet.symbols().size() != header_->symbols_n)
+            throw std::invalid_argument("Alphabet does not match the one of the model file.");
+        for (auto i = 0u; i < header_->symbols_n; ++i) {
+            if (not alphabet.contains(header_->symbols[i]) or alphabet.get_cv(header_->symbols[i]) != header_->effects[i])
+                throw std::invalid_argument("Alphabet does not match the one of the model file.");
+        }
+
+        auto res = V1CA(alphabet);
+        res.states_n_ = header_->states_n;
+        res.init_state_ = header_->init_state;
+        res.max_level_ = header_->max_level;
+        res.final_states_.insert(finals_, finals_ + header_->finals_n);
+        for (auto state = 0u; state < header_->states_n; ++state)
+            res.state_props_.insert({state, {level(state), std::string(name(state))}});
+
+        for (auto state = 0u; state < header_->states_n; ++state) {
+            for (auto cv = 0u; cv <= header_->max_level; ++cv) {
+                for (auto i = 0u; i < header_->symbols_n; ++i) {
+                    const auto *trans = step(state, cv, header_->symbols[i]);
+                    if (trans)
+                        res.transitions_.assign(state, header_->symbols[i], cv, cv,
+                                                {trans->state, static_cast<V1CA::transition_color>(trans->data)});
+                }
+            }
+        }
+
+        return res;
+    }
+
+    /**
+     * Build the R1CA stored in the mapped file
+     * @param alphabet The alphabet of the R1CA, which must be the one it was written with
+     * @throws runtime_error if the file does not contain a R1CA
+     * @throws invalid_argument if the alphabet is not the one of the file
+     */
+    R1CA model_view::to_r1ca(basic_alphabet_t &alphabet) const {
+        if (header_->kind != model_kind::r1ca)
+            throw std::runtime_error("Model file does not contain a R1CA.");
+        if (alphabet.symbols().size() != header_->symbols_n)
+            throw std::invalid_argument("Alphabet does not match the one of the model file.");
+        for (auto i = 0u; i < header_->symbols_n; ++i) {
+            if (not alphabet.contains(header_->symbols[i]))
+                throw std::invalid_argument("Alphabet does not match the one of the model file.");
+        }
+
+        auto transitions = R1CA::transition_func_t();
+        for (auto state = 0u; state < header_->states_n; ++state) {
+            for (auto cv = 0u; cv <= header_->max_level; ++cv) {
+                for (auto i = 0u; i < header_->symbols_n; ++i) {
+                    const auto *trans = step(state, cv, header_->symbols[i]);
+                    if (trans)
+                        transitions.assign(state, header_->symbols[i], cv, cv, {trans->state, trans->data});
+                }
+            }
+        }
+
+        return R1CA::from_scratch(header_->init_state, header_->states_n, header_->max_level,
+                                  std::set<size_t>(finals_, finals_ + header_->finals_n), transitions, alphabet);
+    }
+}
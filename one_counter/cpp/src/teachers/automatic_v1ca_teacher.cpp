@@ -1,6 +1,8 @@
 #include "teachers/automatic_v1ca_teacher.h"
 #include "language.h"
 #include "behaviour_graph.h"
+#include "v1ca_behaviour_view.h"
+#include "trace.h"
 
 #include <utility>
 
@@ -10,17 +12,18 @@ namespace active_learning {
     automatic_v1ca_teacher::partial_equivalence_query(behaviour_graph &behaviour_graph,
                                                       const std::string &path) {
         (void) path; // unused
-        auto basic_v1ca = behaviour_graph.to_v1ca_direct((visibly_alphabet_t &) automaton_ref_.get_alphabet());
-
-        return automaton_ref_.is_equivalent_to(basic_v1ca);
+        V1C2AL_TRACE_SPAN("teacher::partial_equivalence_query");
+        // The behaviour graph only describes the levels seen so far, so the reference is compared on those only
+        return behaviour_graph.find_difference_up_to_level(v1ca_behaviour_view(automaton_ref_));
     }
 
     std::optional<std::string>
     automatic_v1ca_teacher::equivalence_query(one_counter_automaton &automaton, const std::string &path) {
         (void) path; // unused
+        V1C2AL_TRACE_SPAN("teacher::equivalence_query");
         auto &v1ca = oca_to_v1ca(automaton);
 
-        return automaton_ref_.is_equivalent_to(v1ca);
+        return automaton_ref_.is_equivalent_to(v1ca, engine_);
     }
 
     bool active_learning::automatic_v1ca_teacher::membership_query_(const std::string &word) {
@@ -28,11 +31,10 @@ namespace active_learning {
     }
 
     automatic_v1ca_teacher::automatic_v1ca_teacher(V1CA &automatonRef,
-                                                   visibly_alphabet_t alphabet) :
+                                                   visibly_alphabet_t alphabet,
+                                                   V1CA::equivalence_engine engine) :
             automaton_ref_(automatonRef), alphabet_(
-            std::move(alphabet)) {
-        behaviour_ref_ = std::make_unique<behaviour_graph>(behaviour_graph::from_v1ca(automatonRef));
-    }
+            std::move(alphabet)), engine_(engine) {}
 
     V1CA &automatic_v1ca_teacher::oca_to_v1ca(one_counter_automaton &v1ca) {
         auto *v1ca_ptr = dynamic_cast<V1CA *>(&v1ca);
@@ -2,6 +2,8 @@
 #include "teachers/automaton_teacher.h"
 #include "language.h"
 #include "behaviour_graph.h"
+#include "trace.h"
+#include "visualization_sink.h"
 
 namespace active_learning {
 
@@ -13,8 +15,15 @@ namespace active_learning {
         return ref_.count(word);
     }
 
+    std::vector<int> automaton_teacher::count_prefixes_query(const std::string &word) const {
+        return ref_.count_prefixes(word);
+    }
+
     std::optional<std::string> automaton_teacher::partial_equivalence_query(behaviour_graph &behaviour_graph, const std::string& path) {
+        V1C2AL_TRACE_SPAN("teacher::partial_equivalence_query");
         behaviour_graph.display(path);
+        // The image must exist before the user is asked to look at it
+        visualization_sink::get_default().flush();
 
         std::cout << "Please check the behaviour graph (graph name should be " << path
                   << ".png) and give a counter example, or enter 'OK' if the graph is good ";
@@ -33,8 +42,10 @@ namespace active_learning {
     }
 
     std::optional<std::string> automaton_teacher::equivalence_query(one_counter_automaton &automaton, const std::string& path) {
+        V1C2AL_TRACE_SPAN("teacher::equivalence_query");
         auto &r1ca = oca_to_r1ca(automaton);
         r1ca.display(path);
+        visualization_sink::get_default().flush();
 
         std::cout << "Please check the R1CA automaton (automaton name should be " << path
                   << ".png) and give a counter example, or 'OK' if the automaton is good ";
@@ -67,4 +78,8 @@ namespace active_learning {
         return count_query(word);
     }
 
+    std::vector<int> automaton_teacher::get_prefixes_cv(const std::string &word) const {
+        return count_prefixes_query(word);
+    }
+
 }
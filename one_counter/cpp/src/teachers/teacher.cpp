@@ -14,6 +14,19 @@ namespace active_learning {
         return res;
     }
 
+    /**
+     * Ask several membership queries at once. Teachers able to answer a batch faster than one query at a time
+     * should override this.
+     * @return The answers, in the order of the words
+     */
+    std::vector<bool> teacher::membership_queries(const std::vector<std::string> &words) {
+        auto res = std::vector<bool>(words.size());
+        for (auto i = 0ul; i < words.size(); ++i)
+            res[i] = membership_query(words[i]);
+
+        return res;
+    }
+
     std::string cached_teacher::sum_up_msg() const {
         return "Learning took " + std::to_string(query_cache_.size()) + " membership queries.";
     }
@@ -21,4 +34,13 @@ namespace active_learning {
     std::string teacher::sum_up_msg() const {
         return std::string();
     }
+
+    // Number of distinct membership queries asked, 0 for teachers not keeping track of them
+    size_t teacher::get_membership_queries_n() const {
+        return 0;
+    }
+
+    size_t cached_teacher::get_membership_queries_n() const {
+        return query_cache_.size();
+    }
 }
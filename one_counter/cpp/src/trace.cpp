@@ -0,0 +1,163 @@
+#include "trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+namespace active_learning {
+
+    namespace {
+        // Small ids of the threads spans are recorded on, in order of their first span
+        uint32_t thread_id() {
+            static std::atomic<uint32_t> next_id = 0;
+            thread_local uint32_t id = next_id++;
+            return id;
+        }
+
+        thread_local trace_span *innermost_span = nullptr;
+
+        uint64_t clock_ns() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    }
+
+    tracer &tracer::get_default() {
+        static tracer trace;
+        return trace;
+    }
+
+    /**
+     * Start recording spans, dropping the ones of a previous trace
+     * @param output How spans are kept
+     * @param path The file the Chrome JSON is written to when the trace stops, nothing being written if it is empty
+     * @param ring_capacity The number of spans kept by a ring buffer
+     */
+    void tracer::start(trace_output output, const std::string &path, size_t ring_capacity) {
+        auto lock = std::unique_lock(mutex_);
+        path_ = path;
+        events_.clear();
+        ring_capacity_ = (output == trace_output::ring_buffer) ? std::max<size_t>(ring_capacity, 1) : 0;
+        ring_next_ = 0;
+        events_.reserve(ring_capacity_);
+        origin_ns_ = clock_ns();
+        active_ = true;
+    }
+
+    /**
+     * Stop recording spans, and write them if the trace has a path. Spans kept can still be read afterwards.
+     */
+    void tracer::stop() {
+        active_ = false;
+        if (!path_.empty())
+            write_chrome_json(path_);
+    }
+
+    bool tracer::is_active() const {
+        return active_;
+    }
+
+    // Time since the start of the trace
+    uint64_t tracer::now_ns() const {
+        return clock_ns() - origin_ns_;
+    }
+
+    void tracer::record(const trace_event &event) {
+        auto lock = std::unique_lock(mutex_);
+        if (ring_capacity_ == 0 or events_.size() < ring_capacity_) {
+            events_.push_back(event);
+            return;
+        }
+
+        events_[ring_next_] = event;
+        ring_next_ = (ring_next_ + 1) % ring_capacity_;
+    }
+
+    /**
+     * @return The spans kept, from the oldest one to be closed to the newest
+     */
+    std::vector<trace_event> tracer::get_events() const {
+        auto lock = std::unique_lock(mutex_);
+        auto res = std::vector<trace_event>(events_.begin() + static_cast<long>(ring_next_), events_.end());
+        res.insert(res.end(), events_.begin(), events_.begin() + static_cast<long>(ring_next_));
+
+        return res;
+    }
+
+    /**
+     * Write the spans kept as Chrome trace-event JSON, which can be opened by chrome://tracing or Perfetto
+     * @throws runtime_error if the file cannot be opened
+     */
+    void tracer::write_chrome_json(const std::string &path) const {
+        std::ofstream out;
+        out.open(path);
+        if (!out.is_open())
+            throw std::runtime_error("write_chrome_json(): Could not open '" + path + "'.");
+        out << "{\"traceEvents\":[\n";
+
+        auto first = true;
+        for (const auto &event : get_events()) {
+            if (!first)
+                out << ",\n";
+            first = false;
+
+            // Timestamps are in microseconds
+            out << R"({"name":")" << event.name << R"(","cat":"v1c2al","ph":"X","pid":1,"tid":)" << event.thread
+                << ",\"ts\":" << event.start_ns / 1000 << '.' << event.start_ns / 100 % 10
+                << ",\"dur\":" << event.duration_ns / 1000 << '.' << event.duration_ns / 100 % 10
+                << ",\"args\":{";
+            for (auto i = 0u; i < event.args_n; ++i) {
+                if (i > 0)
+                    out << ',';
+                out << '"' << event.args[i].first << "\":" << event.args[i].second;
+            }
+            out << "}}";
+        }
+
+        out << "\n]}\n";
+    }
+
+    trace_span::trace_span(const char *name) {
+        auto &trace = tracer::get_default();
+        if (!trace.is_active())
+            return;
+
+        active_ = true;
+        event_.name = name;
+        event_.thread = thread_id();
+        parent_ = innermost_span;
+        innermost_span = this;
+        event_.start_ns = trace.now_ns();
+    }
+
+    trace_span::~trace_span() {
+        if (!active_)
+            return;
+
+        auto &trace = tracer::get_default();
+        event_.duration_ns = trace.now_ns() - event_.start_ns;
+        innermost_span = parent_;
+        if (trace.is_active())
+            trace.record(event_);
+    }
+
+    /**
+     * Annotate the innermost span of the calling thread, replacing the value of a key it already has.
+     * Annotations beyond trace_event::max_args are dropped.
+     */
+    void trace_span::annotate(const char *key, int64_t value) {
+        auto *span = innermost_span;
+        if (!span)
+            return;
+
+        auto &event = span->event_;
+        for (auto i = 0u; i < event.args_n; ++i) {
+            if (std::string_view(event.args[i].first) == key) {
+                event.args[i].second = value;
+                return;
+            }
+        }
+        if (event.args_n < trace_event::max_args)
+            event.args[event.args_n++] = {key, value};
+    }
+}
@@ -0,0 +1,120 @@
+#include "v1ca_behaviour_view.h"
+
+namespace active_learning {
+
+    /**
+     * @param automaton The V1CA to be viewed, which must outlive the view
+     */
+    v1ca_behaviour_view::v1ca_behaviour_view(const V1CA &automaton) : automaton_(automaton) {}
+
+    size_t v1ca_behaviour_view::states_n() const {
+        return automaton_.states_n_;
+    }
+
+    size_t v1ca_behaviour_view::vertices_n() const {
+        return automaton_.states_n_;
+    }
+
+    size_t v1ca_behaviour_view::max_level() const {
+        return automaton_.max_level_;
+    }
+
+    v1ca_behaviour_view::state_t v1ca_behaviour_view::init_state() const {
+        return automaton_.init_state_;
+    }
+
+    size_t v1ca_behaviour_view::level(state_t state) const {
+        return automaton_.state_props_.at(state).level;
+    }
+
+    const std::string &v1ca_behaviour_view::name(state_t state) const {
+        return automaton_.state_props_.at(state).name;
+    }
+
+    size_t v1ca_behaviour_view::id(state_t state) const {
+        return state;
+    }
+
+    bool v1ca_behaviour_view::is_final(state_t state) const {
+        return automaton_.final_states_.contains(state);
+    }
+
+    bool v1ca_behaviour_view::is_init(state_t state) const {
+        return state == automaton_.init_state_;
+    }
+
+    int v1ca_behaviour_view::effect(char symbol) const {
+        return automaton_.alphabet_.get_cv(symbol);
+    }
+
+    const V1CA &v1ca_behaviour_view::base() const {
+        return automaton_;
+    }
+
+    /**
+     * Follow the edge of the behaviour graph leaving a vertex with a symbol. The vertex is reached with a counter
+     * value equal to its level, and transitions going above the max level are not part of the graph.
+     * @return The target vertex, std::nullopt if there is no such edge
+     */
+    std::optional<v1ca_behaviour_view::state_t> v1ca_behaviour_view::get_next_vertex(state_t from, char symbol) const {
+        auto from_level = level(from);
+        if (from_level >= automaton_.max_level_ and effect(symbol) > 0)
+            return std::nullopt;
+
+        return step(from, symbol, from_level);
+    }
+
+    /**
+     * Find a vertex having an edge with a symbol to a given vertex. As the V1CA is not indexed by target,
+     * only the states of the level the edge comes from are looked at.
+     * @return The first such vertex, std::nullopt if there is none
+     */
+    std::optional<v1ca_behaviour_view::state_t> v1ca_behaviour_view::get_prev_vertex(state_t to, char symbol) const {
+        auto from_level = static_cast<long>(level(to)) - effect(symbol);
+        if (from_level < 0)
+            return std::nullopt;
+
+        for (auto state : get_all_states_of_level(from_level)) {
+            if (get_next_vertex(state, symbol) == to)
+                return state;
+        }
+
+        return std::nullopt;
+    }
+
+    /**
+     * Find every vertex having an edge with a symbol to a given vertex
+     * @see get_prev_vertex
+     */
+    v1ca_behaviour_view::states_t v1ca_behaviour_view::get_prev_vertices(state_t to, char symbol) const {
+        states_t res;
+        auto from_level = static_cast<long>(level(to)) - effect(symbol);
+        if (from_level < 0)
+            return res;
+
+        for (auto state : get_all_states_of_level(from_level)) {
+            if (get_next_vertex(state, symbol) == to)
+                res.push_back(state);
+        }
+
+        return res;
+    }
+
+    v1ca_behaviour_view::states_t v1ca_behaviour_view::get_all_states_of_level(size_t level) const {
+        states_t res;
+        for (const auto &[state, prop] : automaton_.state_props_) {
+            if (prop.level == level)
+                res.emplace_back(state);
+        }
+
+        return res;
+    }
+
+    std::optional<v1ca_behaviour_view::state_t> v1ca_behaviour_view::step(state_t from, char symbol, size_t cv) const {
+        const auto *trans = automaton_.step(from, cv, symbol);
+        if (not trans)
+            return std::nullopt;
+
+        return trans->state;
+    }
+}
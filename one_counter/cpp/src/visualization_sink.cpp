@@ -0,0 +1,123 @@
+#include "visualization_sink.h"
+
+#include <fstream>
+
+namespace active_learning {
+
+    visualization_sink::visualization_sink(visualization_mode mode) : mode_(mode) {}
+
+    /**
+     * Write and render every graph still waiting, then stop the worker
+     */
+    visualization_sink::~visualization_sink() {
+        {
+            auto lock = std::unique_lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable())
+            worker_.join();
+    }
+
+    visualization_sink &visualization_sink::get_default() {
+        static visualization_sink sink;
+        return sink;
+    }
+
+    /**
+     * Change the mode of the graphs submitted from now on, graphs already submitted keep their mode
+     */
+    void visualization_sink::set_mode(visualization_mode mode) {
+        auto lock = std::unique_lock(mutex_);
+        mode_ = mode;
+    }
+
+    visualization_mode visualization_sink::get_mode() const {
+        auto lock = std::unique_lock(mutex_);
+        return mode_;
+    }
+
+    bool visualization_sink::is_enabled() const {
+        return get_mode() != visualization_mode::disabled;
+    }
+
+    /**
+     * Hand a graph over to the worker, without waiting for it to be written
+     * @param path The path to the .dot and .png files, without the extension
+     * @param dot The graph, as DOT text
+     */
+    void visualization_sink::submit(const std::string &path, std::string dot) {
+        {
+            auto lock = std::unique_lock(mutex_);
+            if (mode_ == visualization_mode::disabled)
+                return;
+
+            auto [job, inserted] = pending_.insert_or_assign(path, job_t{std::move(dot), mode_});
+            if (inserted)
+                queue_.push_back(path);
+            else
+                ++coalesced_;
+
+            if (!worker_.joinable())
+                worker_ = std::thread(&visualization_sink::run, this);
+        }
+        wake_.notify_one();
+    }
+
+    /**
+     * Wait until every graph submitted so far is written and rendered
+     */
+    void visualization_sink::flush() {
+        auto lock = std::unique_lock(mutex_);
+        idle_.wait(lock, [this]() { return queue_.empty() and !busy_; });
+    }
+
+    size_t visualization_sink::written() const {
+        auto lock = std::unique_lock(mutex_);
+        return written_;
+    }
+
+    size_t visualization_sink::coalesced() const {
+        auto lock = std::unique_lock(mutex_);
+        return coalesced_;
+    }
+
+    void visualization_sink::run() {
+        auto lock = std::unique_lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ or !queue_.empty(); });
+            // Only stopping once everything is written
+            if (queue_.empty())
+                return;
+
+            auto path = std::move(queue_.front());
+            queue_.pop_front();
+            auto node = pending_.extract(path);
+            busy_ = true;
+
+            lock.unlock();
+            write(path, node.mapped());
+            lock.lock();
+
+            busy_ = false;
+            ++written_;
+            if (queue_.empty())
+                idle_.notify_all();
+        }
+    }
+
+    void visualization_sink::write(const std::string &path, const job_t &job) {
+        std::string full_path = path + ".dot";
+        std::ofstream file;
+        file.open(full_path, std::ios::binary);
+        file.write(job.dot.data(), static_cast<std::streamsize>(job.dot.size()));
+        file.close();
+
+        if (job.mode != visualization_mode::async_png)
+            return;
+
+        // Creating png file
+        // Hoping that you are on linux and have dot installed
+        system(("dot -Tpng " + full_path + " > " + path + ".png").c_str());
+    }
+}